@@ -0,0 +1,127 @@
+#pragma once
+#include <culprit-framework/CulpritFramework.h>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+using namespace culprit::framework;
+
+///
+/// Resolve Dependencies
+///
+class Dependency1 {};
+class Dependency2 {};
+class Dependency3 {};
+
+class Model {
+ public:
+  int value{0};
+};
+
+class SingletonModel : public Model {};
+
+class ModelWith1Dependency : public Model {
+ public:
+  ModelWith1Dependency(std::shared_ptr<Dependency1>) {}
+};
+
+class ModelWith2Dependencies : public Model {
+ public:
+  ModelWith2Dependencies(std::shared_ptr<Dependency1>,
+                         std::shared_ptr<Dependency2>) {}
+};
+
+class ModelWith3Dependencies : public Model {
+ public:
+  ModelWith3Dependencies(std::shared_ptr<Dependency1>,
+                         std::shared_ptr<Dependency2>,
+                         std::shared_ptr<Dependency3>) {}
+};
+
+///
+/// Signals and Commands
+///
+class BenchSignal : public Signal<> {};
+
+class Listener {
+ public:
+  void OnSignal() { ++calls; }
+
+  std::size_t calls{0};
+};
+
+class NoopCommand : public CommandBase {
+ public:
+  NoopCommand(std::shared_ptr<SingletonModel> model) : m_model(model) {}
+
+  void Execute(std::shared_ptr<SignalBase> signal) override {
+    ++m_model->value;
+    Release();
+  }
+
+ private:
+  std::shared_ptr<SingletonModel> m_model;
+};
+
+///
+/// Updatables
+///
+template <std::size_t I>
+class CountingUpdatable : public IUpdatable<CountingUpdatable<I>> {
+ public:
+  void PreUpdate() { ++preUpdates; }
+  void Update(double deltaTime) { elapsed += deltaTime; }
+  void PostUpdate() { ++postUpdates; }
+
+  std::size_t preUpdates{0};
+  double elapsed{0.0};
+  std::size_t postUpdates{0};
+};
+
+///
+/// Contexts
+///
+class ResolveContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SingletonModel>().ToSingleton<SingletonModel>();
+    Bind<Model>().To<Model>();
+    Bind<Dependency1>().ToSingleton<Dependency1>();
+    Bind<Dependency2>().ToSingleton<Dependency2>();
+    Bind<Dependency3>().ToSingleton<Dependency3>();
+    Bind<ModelWith1Dependency>().To<ModelWith1Dependency, Dependency1>();
+    Bind<ModelWith2Dependencies>()
+        .To<ModelWith2Dependencies, Dependency1, Dependency2>();
+    Bind<ModelWith3Dependencies>()
+        .To<ModelWith3Dependencies, Dependency1, Dependency2, Dependency3>();
+  }
+};
+
+class CommandChainContext : public ContextBase {
+ public:
+  explicit CommandChainContext(std::size_t chainLength)
+      : m_chainLength{chainLength} {}
+
+ private:
+  void SetBindings() override {
+    Bind<SingletonModel>().ToSingleton<SingletonModel>();
+
+    auto chain = On<BenchSignal>();
+    for (std::size_t i = 0; i < m_chainLength; ++i) {
+      chain.Do<NoopCommand, SingletonModel>();
+    }
+  }
+
+  std::size_t m_chainLength;
+};
+
+class EmptyContext : public ContextBase {
+  void SetBindings() override {}
+};
+
+template <std::size_t... Is>
+void AddCountingUpdatables(ContextBase& context, std::index_sequence<Is...>) {
+  (context.AddUpdatable<CountingUpdatable<Is>>(
+       std::make_shared<CountingUpdatable<Is>>()),
+   ...);
+}
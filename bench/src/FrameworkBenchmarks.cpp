@@ -0,0 +1,219 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkDefinitions.h"
+
+namespace {
+template <class Context, class... Args>
+std::shared_ptr<Context> MakeContext(Args&&... args) {
+  auto context = std::make_shared<Context>(std::forward<Args>(args)...);
+  context->Initialise();
+  context->Enter();
+  return context;
+}
+}  // namespace
+
+///
+/// Resolve
+///
+static void BM_ResolveSingleton(benchmark::State& state) {
+  auto context = MakeContext<ResolveContext>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->Resolve<SingletonModel>());
+  }
+}
+BENCHMARK(BM_ResolveSingleton);
+
+static void BM_ResolveRefSingleton(benchmark::State& state) {
+  auto context = MakeContext<ResolveContext>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->ResolveRef<SingletonModel>().get());
+  }
+}
+BENCHMARK(BM_ResolveRefSingleton);
+
+static void BM_ResolveTransient(benchmark::State& state) {
+  auto context = MakeContext<ResolveContext>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->Resolve<Model>());
+  }
+}
+BENCHMARK(BM_ResolveTransient);
+
+template <class Resolved>
+static void BM_ResolveWithDependencies(benchmark::State& state) {
+  auto context = MakeContext<ResolveContext>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->Resolve<Resolved>());
+  }
+}
+BENCHMARK_TEMPLATE(BM_ResolveWithDependencies, ModelWith1Dependency);
+BENCHMARK_TEMPLATE(BM_ResolveWithDependencies, ModelWith2Dependencies);
+BENCHMARK_TEMPLATE(BM_ResolveWithDependencies, ModelWith3Dependencies);
+
+///
+/// Signals and Commands
+///
+static void BM_DispatchToListeners(benchmark::State& state) {
+  BenchSignal signal;
+  std::vector<Listener> listeners(static_cast<std::size_t>(state.range(0)));
+  for (auto& listener : listeners) {
+    signal.Attach(&listener, &Listener::OnSignal);
+  }
+
+  for (auto _ : state) {
+    signal.Dispatch();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DispatchToListeners)->RangeMultiplier(4)->Range(1, 256);
+
+static void BM_CommandChain(benchmark::State& state) {
+  auto context = MakeContext<CommandChainContext>(
+      static_cast<std::size_t>(state.range(0)));
+  auto signal = context->Resolve<BenchSignal>();
+
+  for (auto _ : state) {
+    signal->Dispatch();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CommandChain)->RangeMultiplier(2)->Range(1, 32);
+
+///
+/// Updatables
+///
+static void BM_AddRemoveUpdatable(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  for (auto _ : state) {
+    context->AddUpdatable<CountingUpdatable<0>>(
+        std::make_shared<CountingUpdatable<0>>());
+    context->RemoveUpdatable<CountingUpdatable<0>>();
+    // Removals are processed here, and released in PostUpdate.
+    context->PreUpdate();
+    context->PostUpdate();
+  }
+}
+BENCHMARK(BM_AddRemoveUpdatable);
+
+template <std::size_t N>
+static void BM_UpdatePhases(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  AddCountingUpdatables(*context, std::make_index_sequence<N>{});
+
+  for (auto _ : state) {
+    context->PreUpdate();
+    context->Update(1.0 / 60.0);
+    context->PostUpdate();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_UpdatePhases, 1);
+BENCHMARK_TEMPLATE(BM_UpdatePhases, 8);
+BENCHMARK_TEMPLATE(BM_UpdatePhases, 64);
+
+///
+/// Child Contexts
+///
+static void BM_AddRemoveChildContext(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  for (auto _ : state) {
+    context->AddChildContext<ResolveContext>()->Enter();
+    context->RemoveChildContext<ResolveContext>();
+    // Releases the removed child.
+    context->PostUpdate();
+  }
+}
+BENCHMARK(BM_AddRemoveChildContext);
+
+static void BM_AddRemovePooledChildContext(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  context->ReserveChildContexts<ResolveContext>(1);
+  for (auto _ : state) {
+    const auto handle = context->AddChildContextInstance<ResolveContext>();
+    context->RemoveChildContext(handle);
+  }
+}
+BENCHMARK(BM_AddRemovePooledChildContext);
+
+///
+/// Store
+///
+static void BM_StoreAndDelete(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  auto model = std::make_shared<Model>();
+  for (auto _ : state) {
+    context->Store<Model>(model);
+    context->DeleteFromStore<Model>();
+    // Deletions are processed here, and released in PostUpdate.
+    context->PreUpdate();
+    context->PostUpdate();
+  }
+}
+BENCHMARK(BM_StoreAndDelete);
+
+static void BM_GetFromStore(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  context->Store<Model>(std::make_shared<Model>());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->GetFromStore<Model>());
+  }
+}
+BENCHMARK(BM_GetFromStore);
+
+static void BM_SharedStoreRead(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  context->StoreShared<Model>(std::make_shared<Model>());
+  context->Tick(1.0 / 60.0);
+  const auto store = context->GetSharedStore();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(store->Get<Model>());
+  }
+}
+BENCHMARK(BM_SharedStoreRead);
+
+// A frame's worth of shared writes, published in one commit.
+static void BM_SharedStoreBatchedWrites(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  auto model = std::make_shared<Model>();
+  for (auto _ : state) {
+    for (int i = 0; i < state.range(0); ++i) {
+      context->StoreShared<Model>(model);
+    }
+    context->PostUpdate();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SharedStoreBatchedWrites)->Range(1, 64);
+
+static void BM_GetKeyed(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  const auto count = static_cast<KeyedId>(state.range(0));
+  for (KeyedId id = 0; id < count; ++id) {
+    context->StoreKeyed(id, Model{});
+  }
+  KeyedId id = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(context->TryGetKeyed<Model>(id));
+    id = (id + 7919) % count;
+  }
+}
+BENCHMARK(BM_GetKeyed)->Range(1 << 10, 1 << 17);
+
+static void BM_IterateKeyed(benchmark::State& state) {
+  auto context = MakeContext<EmptyContext>();
+  for (KeyedId id = 0; id < static_cast<KeyedId>(state.range(0)); ++id) {
+    context->StoreKeyed(id, Model{});
+  }
+  auto& store = context->GetKeyedStore<Model>();
+  for (auto _ : state) {
+    for (auto& model : store) {
+      benchmark::DoNotOptimize(&model);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IterateKeyed)->Range(1 << 10, 1 << 17);
@@ -0,0 +1,263 @@
+// Builds context trees at increasing scale, runs them for many frames and
+// reports how frame time, memory and allocations grow with the scale.
+//
+//   culprit-framework-soak [--frames N] [--scales 1,2,4,8] [--json path]
+//
+// At scale s the tree has 250 * s contexts plus a 64 deep chain, each with
+// 50 updatables, under a root binding 256 signals with 3 command chains.
+// Every frame dispatches 16 * s of the signals, swaps s leaf contexts for
+// pooled ones and ticks the tree.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "SoakDefinitions.h"
+
+// Allocations are counted by the framework's tracker, which the soak build
+// always links in.
+static_assert(AllocationTracker::IsEnabled(),
+              "The soak benchmark needs CULPRIT_TRACK_ALLOCATIONS");
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kContextsPerScale = 250;
+constexpr std::size_t kDeepChainLength = 64;
+constexpr std::size_t kFanout = 8;
+constexpr std::size_t kDispatchesPerScale = 16;
+constexpr double kDeltaTime = 1.0 / 60.0;
+
+struct Options {
+  std::size_t frames{600};
+  std::vector<std::size_t> scales{1, 2, 4, 8};
+  std::string jsonPath;
+};
+
+struct ScaleResult {
+  std::size_t scale{0};
+  std::size_t contexts{0};
+  std::size_t updatables{0};
+  std::size_t frames{0};
+  double buildMs{0.0};
+  double p50Ms{0.0};
+  double p90Ms{0.0};
+  double p99Ms{0.0};
+  double maxMs{0.0};
+  double framesPerSecond{0.0};
+  double updatablesPerSecond{0.0};
+  std::uint64_t rssBuiltKb{0};
+  std::uint64_t rssEndKb{0};
+  double allocationsPerFrame{0.0};
+};
+
+// A context in the tree, with what's needed to swap it for a pooled one.
+struct Node {
+  ContextBase* parent;
+  ContextHandle handle;
+};
+
+std::uint64_t ReadRssKb() {
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  std::uint64_t pages = 0;
+  std::uint64_t residentPages = 0;
+  if (statm >> pages >> residentPages) {
+    return residentPages * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE)) /
+           1024;
+  }
+#endif
+  return 0;
+}
+
+double ToMs(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  const auto index = std::min(
+      sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+  return sorted[index];
+}
+
+Node AddSoakContext(ContextBase& parent) {
+  const auto handle = parent.AddChildContextInstance<SoakContext>();
+  auto child = parent.GetChildContext<SoakContext>(handle);
+  AddCountingUpdatables(*child,
+                        std::make_index_sequence<kUpdatablesPerContext>{});
+  child->Enter();
+  return Node{&parent, handle};
+}
+
+ScaleResult RunScale(std::size_t scale, std::size_t frames) {
+  ScaleResult result;
+  result.scale = scale;
+  result.frames = frames;
+
+  const auto buildStart = Clock::now();
+  auto root = std::make_shared<SoakRootContext>();
+  root->Initialise();
+  root->Enter();
+
+  // Wide: breadth first, so the last nodes added are leaves.
+  std::vector<Node> nodes;
+  std::vector<ContextBase*> contexts{root.get()};
+  const auto wideCount = kContextsPerScale * scale;
+  for (std::size_t i = 0; i < wideCount; ++i) {
+    auto& parent = *contexts[i / kFanout];
+    nodes.push_back(AddSoakContext(parent));
+    contexts.push_back(
+        parent.GetChildContext<SoakContext>(nodes.back().handle).get());
+  }
+
+  // Deep: a single chain hanging off the root.
+  ContextBase* deepParent = root.get();
+  for (std::size_t i = 0; i < kDeepChainLength; ++i) {
+    const auto node = AddSoakContext(*deepParent);
+    deepParent = deepParent->GetChildContext<SoakContext>(node.handle).get();
+  }
+
+  result.contexts = wideCount + kDeepChainLength;
+  result.updatables = result.contexts * kUpdatablesPerContext;
+  result.buildMs = ToMs(Clock::now() - buildStart);
+
+  const auto signals = ResolveSoakSignals(
+      *root, std::make_index_sequence<kSoakSignalCount>{});
+
+  // One untimed frame so first-use caches are built.
+  root->Tick(kDeltaTime);
+  result.rssBuiltKb = ReadRssKb();
+
+  std::vector<double> frameMs;
+  frameMs.reserve(frames);
+  std::size_t nextSignal = 0;
+  const auto allocationsStart = AllocationTracker::GetCount();
+  const auto runStart = Clock::now();
+
+  for (std::size_t frame = 0; frame < frames; ++frame) {
+    const auto frameStart = Clock::now();
+
+    for (std::size_t i = 0; i < kDispatchesPerScale * scale; ++i) {
+      signals[nextSignal]->Dispatch();
+      nextSignal = (nextSignal + 1) % signals.size();
+    }
+
+    for (std::size_t i = 0; i < scale; ++i) {
+      auto& leaf = nodes[nodes.size() - 1 - i];
+      leaf.parent->RemoveChildContext(leaf.handle);
+      leaf = AddSoakContext(*leaf.parent);
+    }
+
+    root->Tick(kDeltaTime);
+    frameMs.push_back(ToMs(Clock::now() - frameStart));
+  }
+
+  const auto runSeconds =
+      std::chrono::duration<double>(Clock::now() - runStart).count();
+  result.allocationsPerFrame =
+      static_cast<double>(AllocationTracker::GetCount() - allocationsStart) /
+      static_cast<double>(frames);
+  result.rssEndKb = ReadRssKb();
+
+  std::sort(frameMs.begin(), frameMs.end());
+  result.p50Ms = Percentile(frameMs, 0.50);
+  result.p90Ms = Percentile(frameMs, 0.90);
+  result.p99Ms = Percentile(frameMs, 0.99);
+  result.maxMs = frameMs.back();
+  result.framesPerSecond = static_cast<double>(frames) / runSeconds;
+  result.updatablesPerSecond =
+      result.framesPerSecond * static_cast<double>(result.updatables);
+
+  root->Exit();
+  return result;
+}
+
+std::vector<std::size_t> ParseScales(const std::string& list) {
+  std::vector<std::size_t> scales;
+  std::stringstream stream(list);
+  std::string scale;
+  while (std::getline(stream, scale, ',')) {
+    scales.push_back(std::max<std::size_t>(1, std::stoul(scale)));
+  }
+  return scales;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string name = argv[i];
+    const std::string value = argv[i + 1];
+    if (name == "--frames") {
+      options.frames = std::max<std::size_t>(1, std::stoul(value));
+    } else if (name == "--scales") {
+      options.scales = ParseScales(value);
+    } else if (name == "--json") {
+      options.jsonPath = value;
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", name.c_str());
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return options;
+}
+
+void WriteJson(const std::string& path, const std::vector<ScaleResult>& results) {
+  std::ofstream json(path);
+  json << "{\"results\":[";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    json << (i == 0 ? "" : ",") << "{\"scale\":" << result.scale
+         << ",\"contexts\":" << result.contexts
+         << ",\"updatables\":" << result.updatables
+         << ",\"frames\":" << result.frames
+         << ",\"build_ms\":" << result.buildMs
+         << ",\"p50_ms\":" << result.p50Ms << ",\"p90_ms\":" << result.p90Ms
+         << ",\"p99_ms\":" << result.p99Ms << ",\"max_ms\":" << result.maxMs
+         << ",\"frames_per_second\":" << result.framesPerSecond
+         << ",\"updatables_per_second\":" << result.updatablesPerSecond
+         << ",\"rss_built_kb\":" << result.rssBuiltKb
+         << ",\"rss_end_kb\":" << result.rssEndKb
+         << ",\"allocations_per_frame\":" << result.allocationsPerFrame << "}";
+  }
+  json << "]}\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const auto options = ParseOptions(argc, argv);
+
+  std::printf(
+      "%6s %9s %11s %10s %9s %9s %9s %9s %11s %14s %12s %13s\n", "scale",
+      "contexts", "updatables", "build ms", "p50 ms", "p90 ms", "p99 ms",
+      "max ms", "frames/s", "updatables/s", "rss grow kb", "allocs/frame");
+
+  std::vector<ScaleResult> results;
+  for (const auto scale : options.scales) {
+    results.push_back(RunScale(scale, options.frames));
+    const auto& result = results.back();
+    std::printf(
+        "%6zu %9zu %11zu %10.1f %9.3f %9.3f %9.3f %9.3f %11.1f %14.0f %12lld "
+        "%13.1f\n",
+        result.scale, result.contexts, result.updatables, result.buildMs,
+        result.p50Ms, result.p90Ms, result.p99Ms, result.maxMs,
+        result.framesPerSecond, result.updatablesPerSecond,
+        static_cast<long long>(result.rssEndKb) -
+            static_cast<long long>(result.rssBuiltKb),
+        result.allocationsPerFrame);
+  }
+
+  if (!options.jsonPath.empty()) {
+    WriteJson(options.jsonPath, results);
+  }
+  return EXIT_SUCCESS;
+}
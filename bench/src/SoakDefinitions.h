@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkDefinitions.h"
+
+using namespace culprit::framework;
+
+///
+/// Signals
+///
+template <std::size_t I>
+class SoakSignal : public Signal<> {};
+
+constexpr std::size_t kSoakSignalCount = 256;
+constexpr std::size_t kSoakChainLength = 3;
+constexpr std::size_t kUpdatablesPerContext = 50;
+
+///
+/// Contexts
+///
+class SoakRootContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SingletonModel>().ToSingleton<SingletonModel>();
+    BindChains(std::make_index_sequence<kSoakSignalCount>{});
+  }
+
+  template <std::size_t... Is>
+  void BindChains(std::index_sequence<Is...>) {
+    (On<SoakSignal<Is>>()
+         .template Do<NoopCommand, SingletonModel>()
+         .template Do<NoopCommand, SingletonModel>()
+         .template Do<NoopCommand, SingletonModel>(),
+     ...);
+  }
+};
+
+class SoakContext : public ContextBase {
+  void SetBindings() override {}
+};
+
+template <std::size_t... Is>
+std::vector<std::shared_ptr<Signal<>>> ResolveSoakSignals(
+    ContextBase& context, std::index_sequence<Is...>) {
+  return {context.Resolve<SoakSignal<Is>>()...};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace culprit {
+namespace framework {
+
+// The framework operation an allocation happened under, the innermost one
+// when they nest.
+enum class AllocationSite {
+  Other,
+  Resolve,
+  Dispatch,
+  Command,
+  Updatable,
+  Store,
+  Count
+};
+
+// Counts heap allocations made through the global operator new, in total,
+// per site and for the calling thread alone.
+//
+// Only built with CULPRIT_TRACK_ALLOCATIONS, which replaces the global
+// operator new and delete. The counts stay at zero and the
+// CULPRIT_ALLOCATION_SCOPE macro compiles to nothing otherwise.
+class AllocationTracker {
+ public:
+  static constexpr bool IsEnabled() {
+#if defined(CULPRIT_TRACK_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static std::uint64_t GetCount();
+  static std::uint64_t GetCount(AllocationSite site);
+  // Allocations made by the calling thread, unaffected by other threads.
+  static std::uint64_t GetThreadCount();
+
+  // Zeroes the totals and per-site counts, not the per-thread ones.
+  static void Reset();
+
+  static AllocationSite GetCurrentSite();
+  static void SetCurrentSite(AllocationSite site);
+
+  static const char* GetSiteName(AllocationSite site);
+};
+
+class AllocationScope {
+ public:
+  explicit AllocationScope(AllocationSite site)
+      : m_previous{AllocationTracker::GetCurrentSite()} {
+    AllocationTracker::SetCurrentSite(site);
+  }
+
+  ~AllocationScope() { AllocationTracker::SetCurrentSite(m_previous); }
+
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+ private:
+  AllocationSite m_previous;
+};
+
+}  // namespace framework
+}  // namespace culprit
+
+#if defined(CULPRIT_TRACK_ALLOCATIONS)
+#define CULPRIT_ALLOCATION_CONCAT_INNER(a, b) a##b
+#define CULPRIT_ALLOCATION_CONCAT(a, b) CULPRIT_ALLOCATION_CONCAT_INNER(a, b)
+#define CULPRIT_ALLOCATION_SCOPE(site)                                      \
+  ::culprit::framework::AllocationScope CULPRIT_ALLOCATION_CONCAT(          \
+      culpritAllocationScope, __LINE__)(::culprit::framework::AllocationSite:: \
+                                            site)
+#else
+#define CULPRIT_ALLOCATION_SCOPE(site) static_cast<void>(0)
+#endif
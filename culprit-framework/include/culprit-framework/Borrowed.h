@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+namespace culprit {
+namespace framework {
+
+// A non-owning reference to an object the framework owns, such as a bound
+// singleton or a stored object. Copying it costs no reference count traffic,
+// so it suits code that uses an object briefly and often. It doesn't keep
+// the object alive; don't hold on to one past the owner's lifetime.
+//
+// Debug builds also watch the owner and assert on use after it is released.
+template <class T>
+class Borrowed {
+ public:
+  Borrowed() = default;
+
+  Borrowed(T& object, const std::shared_ptr<void>& owner)
+      : m_pObject{&object}
+#if !defined(NDEBUG)
+        ,
+        m_owner{owner}
+#endif
+  {
+    static_cast<void>(owner);
+  }
+
+  template <class U, typename = std::enable_if_t<
+                         std::is_convertible<U*, T*>::value>>
+  Borrowed(const Borrowed<U>& other)
+      : m_pObject{other.m_pObject}
+#if !defined(NDEBUG)
+        ,
+        m_owner{other.m_owner}
+#endif
+  {
+  }
+
+  T& operator*() const { return *get(); }
+  T* operator->() const { return get(); }
+
+  T* get() const {
+#if !defined(NDEBUG)
+    assert((m_pObject == nullptr || !m_owner.expired()) &&
+           "Borrowed object was released while still in use.");
+#endif
+    return m_pObject;
+  }
+
+  explicit operator bool() const { return m_pObject != nullptr; }
+
+ private:
+  template <class>
+  friend class Borrowed;
+
+  T* m_pObject{nullptr};
+#if !defined(NDEBUG)
+  std::weak_ptr<void> m_owner;
+#endif
+};
+
+// Marks a dependency to be passed borrowed rather than shared, e.g.
+// On<Signal>().Do<Command, borrow<Model>>() constructs Command with a
+// Borrowed<Model>. Only singletons can be borrowed.
+template <class T>
+struct borrow {
+  using type = T;
+};
+
+template <class T>
+struct is_borrowed_dependency : std::false_type {};
+
+template <class T>
+struct is_borrowed_dependency<borrow<T>> : std::true_type {};
+
+}  // namespace framework
+}  // namespace culprit
@@ -1,19 +1,37 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
 
+#include "AllocationTracker.h"
+#include "Borrowed.h"
 #include "CommandBase.h"
 #include "Creator.hpp"
+#include "EventSpan.hpp"
+#include "FrameScheduler.h"
 #include "IUpdatable.h"
+#include "KeyedStore.hpp"
+#include "Metrics.h"
+#include "Profiler.h"
+#include "Reclaimer.h"
+#include "Resolver.h"
 #include "Signal.hpp"
 #include "SignalResponder.h"
+#include "SharedStore.h"
+#include "Signals.h"
+#include "Snapshotted.hpp"
+#include "StaticSignal.hpp"
+#include "ThreadingPolicy.h"
 #include "UniqueKeyGenerator.h"
+#include "UpdateRate.h"
+#include "WorkStealingPool.h"
 
 namespace culprit {
 namespace framework {
@@ -28,6 +46,8 @@ class UpdatableWrapper {
     return std::static_pointer_cast<T>(m_updateable);
   }
 
+  const std::shared_ptr<void>& GetOwner() const { return m_updateable; }
+
  private:
   std::shared_ptr<void> m_updateable{nullptr};
 };
@@ -38,34 +58,79 @@ using remove_const_t = typename std::remove_const<T>::type;
 template <typename T>
 inline void ignore_result(const T& /* unused result */) {}
 
-template <typename T, const size_t N = 0>
-struct store_key {};
-
 template <class Key>
 class BindFacade;
 
+struct BindingTemplate;
+
 template <class Key>
 class OnSignalFacade;
 
 using type_identifier = std::size_t;
 
+// Identifies one of possibly many child contexts of the same type. A handle
+// to a removed context never matches the context that reuses its slot.
+using ContextHandle = std::uint64_t;
+
 template <typename T>
 using indexed_ptr = std::pair<size_t, std::shared_ptr<T>>;
 
 class ContextBase : public std::enable_shared_from_this<ContextBase> {
-  using CreatorFunction = std::function<std::shared_ptr<void>()>;
+  using CreatorFunction = Resolver::Creator;
   using InstanceMap =
       std::unordered_map<type_identifier, std::shared_ptr<void>>;
-  using ResolverMap =
-      std::unordered_map<type_identifier, std::shared_ptr<CreatorFunction>>;
-  using CommandResolverMap =
-      std::unordered_map<type_identifier, std::shared_ptr<CreatorFunction>>;
+  using CommandResolverMap = ResolverMap;
   using CommandMap =
       std::unordered_map<type_identifier, std::shared_ptr<SignalResponder>>;
   using StoredObjects =
       std::unordered_map<type_identifier, std::shared_ptr<void>>;
   using UpdatableObjects =
       std::unordered_map<type_identifier, indexed_ptr<UpdatableWrapper>>;
+  // Kept in the order they were added, which is the order they update in.
+  using ChildContexts =
+      std::vector<std::pair<type_identifier, std::shared_ptr<ContextBase>>>;
+  using EventHandler = std::function<void(const void*, std::size_t)>;
+  using EventRoute = std::vector<std::shared_ptr<EventHandler>>;
+
+  enum class Phase { PreUpdate, Update, PostUpdate };
+
+  // A context's own phase, or with isolatedChildren set, its isolated
+  // children's subtrees run in parallel.
+  struct TickStep {
+    std::shared_ptr<ContextBase> context;
+    bool isolatedChildren;
+  };
+
+  // Queues dispatches of signals owned outside an isolated child while it
+  // updates, so they run on the parent's thread at the phase sync point.
+  struct IsolatedDispatchGate : DispatchGate {
+    bool ShouldDefer(const SignalBase& signal) const override;
+    void Defer(std::function<void()> dispatch) override;
+
+    ContextBase* isolatedContext{nullptr};
+    std::vector<std::function<void()>> deferred;
+  };
+
+  // A child loading on a worker, attached by the next PreUpdate once ready.
+  struct PendingChildContext {
+    type_identifier type;
+    std::shared_ptr<ContextBase> context;
+    std::future<void> loaded;
+    std::function<void(std::exception_ptr)> complete;
+  };
+
+  struct ChildSlot {
+    std::shared_ptr<ContextBase> context;
+    type_identifier type{0};
+    std::uint32_t generation{1};
+  };
+
+  struct EventSubscription {
+    // Key of the updatable that subscribed, zero for a context subscription.
+    type_identifier owner;
+    std::size_t token;
+    std::shared_ptr<EventHandler> handler;
+  };
 
   template <typename>
   friend class BindFacade;
@@ -73,7 +138,7 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   friend class OnSignalFacade;
 
  public:
-  virtual ~ContextBase() = default;
+  virtual ~ContextBase();
 
   void Initialise();
   void Enter();
@@ -83,12 +148,69 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   void PostUpdate();
   void Exit();
 
+  // Runs PreUpdate, Update and PostUpdate over this context and its active
+  // children. Same ordering as calling the three phases in turn, but over a
+  // cached flat list of the tree.
+  void Tick(double deltaTime);
+
+  // An inactive child context is skipped, along with everything below it, by
+  // its parent's HandleEvents and update phases. Removals it has queued are
+  // processed once it is active again.
+  void SetActive(bool active);
+  bool IsActive() const { return m_active; }
+
+  // Isolated children of one parent run each phase concurrently with each
+  // other on the worker pool, after the parent's other children. An isolated
+  // child must only change its own subtree. Dispatches of signals owned
+  // outside it are queued until every isolated sibling has finished the
+  // phase, then run in child order.
+  void SetIsolated(bool isolated);
+  bool IsIsolated() const { return m_isolated; }
+
+  // Used for the isolated children of this context and of every context
+  // below it that has no pool of its own. Without a pool isolated children
+  // still sync and queue signals, but run one after another. Single
+  // threaded builds ignore the pool.
+  void SetWorkerPool(std::shared_ptr<WorkStealingPool> pool) {
+    m_pWorkerPool = std::move(pool);
+  }
+
+  // Delivers a batch of events to the handlers subscribed to Event in this
+  // context and its active children. The handler list for each event type is
+  // cached, so the cost is per interested handler rather than per context.
+  template <class Event>
+  void HandleEvents(EventSpan<Event> events);
+
+  template <class Event>
+  void HandleEvent(const Event& event);
+
+  // Routes Event batches to the updatable's OnEvents(EventSpan<Event>). The
+  // subscription ends when the updatable is removed.
+  template <class Event, class Key>
+  void SubscribeEvents();
+
+  template <class Event>
+  std::size_t SubscribeEvents(std::function<void(EventSpan<Event>)> handler);
+
+  void UnsubscribeEvents(std::size_t token);
+
   template <class T>
   std::shared_ptr<T> Resolve();
 
   template <>
   inline std::shared_ptr<ContextBase> Resolve<ContextBase>();
 
+  // The Try* lookups return an empty pointer on a miss instead of throwing,
+  // for code that probes. Each is a single lookup, so there is no need to
+  // check HasStored or HasUpdatable first.
+  template <class T>
+  std::shared_ptr<T> TryResolve();
+
+  // Borrowed access to a singleton, created if it hasn't been yet. Throws for
+  // a transient binding, as nothing else owns what it creates.
+  template <class T>
+  Borrowed<T> ResolveRef();
+
   template <class Dependencies, class... Args>
   decltype(auto) Create(Args&&... args);
 
@@ -98,12 +220,53 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Context>
   std::shared_ptr<Context> GetChildContext() const;
 
+  template <class Context>
+  std::shared_ptr<Context> TryGetChildContext() const;
+
+  template <class Context>
+  Borrowed<Context> GetChildContextRef() const;
+
+  // Initialises and builds the child on the worker pool, then attaches and
+  // enters it at the start of this context's first PreUpdate after it is
+  // ready. The future is fulfilled once it has entered, or carries the
+  // exception if building it failed. Without a worker pool the child is
+  // built straight away but still attached at the next PreUpdate.
+  //
+  // The parent's bindings must not change while the child is loading.
+  template <class Context>
+  std::future<std::shared_ptr<Context>> AddChildContextAsync();
+
   template <class Context>
   bool RemoveChildContext();
 
+  // Adds one more child of type Context, any number of which can live side
+  // by side. A removed instance goes to a pool for its type and is reused by
+  // the next add, keeping the bindings it built and starting its instances,
+  // stores, updatables and children afresh.
+  template <class Context>
+  ContextHandle AddChildContextInstance();
+
+  template <class Context>
+  std::shared_ptr<Context> GetChildContext(ContextHandle handle) const;
+
+  template <class Context>
+  std::shared_ptr<Context> TryGetChildContext(ContextHandle handle) const;
+
+  // The context is exited and pooled, so don't use pointers to it after this.
+  bool RemoveChildContext(ContextHandle handle);
+
+  // Builds count contexts into the pool ahead of time.
+  template <class Context>
+  void ReserveChildContexts(std::size_t count);
+
+  template <class Context>
+  std::size_t GetPooledChildContextCount() const;
+
   template <class Key, const type_identifier N = 0>
   void Store(std::shared_ptr<Key> value);
 
+  // Stores into the tree's shared store, replacing any object already stored
+  // under the key. Other threads see it once the root next commits the store.
   template <class Key, const type_identifier N = 0>
   void StoreShared(std::shared_ptr<Key> value);
 
@@ -113,6 +276,15 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Key, const type_identifier N = 0>
   decltype(auto) GetFromSharedStore();
 
+  template <class Key, const type_identifier N = 0>
+  std::shared_ptr<Key> TryGetFromStore();
+
+  template <class Key, const type_identifier N = 0>
+  std::shared_ptr<Key> TryGetFromSharedStore();
+
+  template <class Key, const type_identifier N = 0>
+  Borrowed<Key> GetFromStoreRef();
+
   template <class Key, const type_identifier N = 0>
   bool HasStored();
 
@@ -125,12 +297,50 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Key, const type_identifier N = 0>
   void DeleteFromSharedStore();
 
+  // The reclaimer for the whole tree, owned by the root.
+  Reclaimer* GetReclaimer() const { return m_pReclaimer; }
+
+  // For reading shared state from other threads, e.g. a render thread.
+  std::shared_ptr<const SharedStore> GetSharedStore() const {
+    return m_pSharedStore;
+  }
+
+  // Stores value under a runtime id, for when there are many objects of one
+  // type, replacing any value already stored under id.
+  template <class Key>
+  void StoreKeyed(KeyedId id, Key value);
+
+  template <class Key>
+  Key& GetKeyed(KeyedId id);
+
+  // nullptr if nothing is stored under id.
   template <class Key>
-  void AddUpdatable(std::shared_ptr<Key> value);
+  Key* TryGetKeyed(KeyedId id);
+
+  template <class Key>
+  bool HasKeyed(KeyedId id);
+
+  // Removed at the next PreUpdate, like DeleteFromStore.
+  template <class Key>
+  void DeleteKeyed(KeyedId id);
+
+  // Every value of the type, contiguous for iterating in bulk.
+  template <class Key>
+  KeyedStore<Key>& GetKeyedStore();
+
+  template <class Key>
+  void AddUpdatable(std::shared_ptr<Key> value,
+                    UpdateRate rate = UpdateRate::EveryFrame());
 
   template <class Key>
   decltype(auto) GetUpdatable();
 
+  template <class Key>
+  std::shared_ptr<Key> TryGetUpdatable();
+
+  template <class Key>
+  Borrowed<Key> GetUpdatableRef();
+
   template<class Key>
   size_t GetUpdatableOrder()
   {
@@ -143,6 +353,16 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Key>
   void RemoveUpdatable();
 
+  // Pauses or resumes an updatable without giving up its slot in the update
+  // lists. A paused reduced-rate updatable does not accumulate time.
+  template <class Key>
+  void SetUpdatableActive(bool active);
+
+  template <class Key>
+  bool IsUpdatableActive() const;
+
+  MetricsSnapshot SnapshotMetrics() const;
+
  protected:
   virtual void SetBindings() = 0;
 
@@ -150,11 +370,13 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   BindFacade<Key> Bind();
 
   void PopulateFromParent(const ContextBase& other) {
+    std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(other.m_mutationMutex);
     m_instanceMap = other.m_instanceMap;
     m_resolverMap = other.m_resolverMap;
 
-    // share stored objects
-    m_sharedStoredObjects = other.m_sharedStoredObjects;
+    // One shared store and one reclaimer for the whole tree.
+    m_pSharedStore = other.m_pSharedStore;
+    m_pReclaimer = other.m_pReclaimer;
 
     // We don't want to share any other maps, especially commands
   }
@@ -165,15 +387,54 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Key>
   void RemoveBind();
 
+  // Binds Key to a plain function of the owning context, for bindings that
+  // aren't built through the facades. Resolved afresh every time, so the
+  // function decides whether to hand out a shared instance. Unlike Bind, it
+  // shadows a binding of Key inherited from the parent.
+  template <class Key>
+  void BindCreator(std::shared_ptr<Key> (*create)(ContextBase&));
+
   template <class T>
   bool HasBinding() const;
 
   template <class Signal>
   OnSignalFacade<Signal> On();
 
+  // Called when a pooled context is reused, before its singletons are
+  // created and it is entered again. Reset any state kept outside the
+  // framework here.
+  virtual void OnRecycle() {}
+
+  // Held while the context's bindings, children or stores change. Derived
+  // contexts take it to create anything Resolve can reach from other threads.
+  ThreadingPolicy::RecursiveMutex& GetMutationMutex() const {
+    return m_mutationMutex;
+  }
+
+  // Called on the root only, for the reclaimer the whole tree retires to.
+  virtual std::unique_ptr<Reclaimer> CreateReclaimer() const {
+    return std::make_unique<Reclaimer>();
+  }
+
+  // Return true if SetBindings always binds the same things given the same
+  // inherited bindings. The first context of the type records what it bound
+  // and later ones copy that record instead of running SetBindings. Each
+  // distinct set of inherited binding keys gets its own record.
+  virtual bool UsesBindingTemplate() const { return false; }
+
  private:
   template <class Key>
-  std::shared_ptr<Key> Resolve(type_identifier keyID);
+  std::shared_ptr<Key> TryResolve(type_identifier keyID);
+
+  // Resolves from the maps rather than the published table, for misses and
+  // for contexts still being built. Holds the mutation lock, so a lazily
+  // created singleton is only ever created once.
+  template <class Key>
+  std::shared_ptr<Key> ResolveLocked(type_identifier keyID);
+
+  // Resolves a creator's dependency, borrowed if wrapped in borrow<>.
+  template <class Dependency>
+  decltype(auto) ResolveDependency();
 
   template <class Dependencies, class... Args>
   decltype(auto) ResolveInPlace(Args&&... args);
@@ -193,36 +454,185 @@ class ContextBase : public std::enable_shared_from_this<ContextBase> {
   template <class Key, class Value, class... Dependencies, class... Args>
   void ToSingleton(Args&&... args);
 
+  template <class Key, class Value, class... Dependencies, class... Args>
+  void ToSnapshotted(Args&&... args);
+
+  template <class Key>
+  static void PublishSnapshot(ContextBase& context);
+
   template <class Key, class Value, class... Dependencies, class... Args>
   void Do(Args&&... args);
 
   void Build();
 
+  // Snapshots the bindings and singletons for lock-free resolution. The
+  // superseded table is kept, a reader on another thread may still hold it.
+  void PublishResolutionTable();
+
+  void ApplyBindings();
+  std::shared_ptr<const BindingTemplate> RecordBindingTemplate(
+      const std::vector<type_identifier>& inheritedKeys) const;
+  void StampBindingTemplate(const BindingTemplate& bindingTemplate);
+  std::size_t FingerprintBindings() const;
+
+  void PreUpdateSelf();
+  void UpdateSelf(double deltaTime);
+  void PostUpdateSelf();
+
+  const std::vector<TickStep>& GetTickOrder();
+  void CollectTickOrder(std::vector<TickStep>& order);
+  void RunTickPhase(Phase phase, double deltaTime);
+
+  void RunIsolatedChildren(const std::function<void(ContextBase&)>& phase);
+  WorkStealingPool* GetWorkerPool() const;
+
+  ChildContexts::const_iterator FindChildContext(
+      type_identifier contextKey) const;
+
+  // Visits the children there were when it started, skipping any removed
+  // during the walk. Removals only erase from m_childContexts once no walk
+  // is in progress, so the phases can run code that removes siblings.
+  struct ChildIterationScope;
+  void ForEachChildContext(const std::function<void(ContextBase&)>& visit);
+  void EraseChildContext(ChildContexts::const_iterator child);
+
+  void QueueChildContextLoad(type_identifier contextKey,
+                             std::shared_ptr<ContextBase> child,
+                             std::function<void(std::exception_ptr)> complete);
+  void AttachLoadedChildContexts();
+  void AttachToInheritedSignal(type_identifier signalID);
+
+  std::shared_ptr<ContextBase> TakePooledChildContext(
+      type_identifier contextKey);
+  ContextHandle AttachChildContextInstance(type_identifier contextKey,
+                                           std::shared_ptr<ContextBase> child);
+  const ChildSlot* FindChildSlot(ContextHandle handle) const;
+  void Recycle(const ContextBase& parent);
+
+  void EraseStoredObject(type_identifier storedKey);
+  void ApplyKeyedRemovals();
+  void Retire(std::shared_ptr<void> object);
+  // Stops this subtree retiring to the tree's reclaimer, for when it may
+  // outlive it.
+  void ForgetReclaimer();
+  // Flags this subtree as removed, so a phase walking the cached tick order
+  // skips all of it, not just its root.
+  void MarkRemoved();
+
+  std::size_t AddEventSubscription(type_identifier eventID,
+                                   type_identifier owner,
+                                   std::shared_ptr<EventHandler> handler);
+  std::shared_ptr<const EventRoute> GetEventRoute(type_identifier eventID);
+  void CollectEventHandlers(type_identifier eventID, EventRoute& route) const;
+  void RemoveEventSubscriptions(type_identifier owner);
+  void InvalidateTraversalCaches();
+
+  void CollectMetrics(
+      MetricsSnapshot& snapshot,
+      std::unordered_map<type_identifier, std::size_t>& signalIndices,
+      std::size_t depth) const;
+
  private:
-  std::unordered_map<type_identifier, std::shared_ptr<ContextBase>>
-      m_childContexts;
+  ChildContexts m_childContexts;
+  unsigned int m_childIterationDepth{0};
+  bool m_hasErasedChildContexts{false};
+  bool m_active{true};
+  bool m_removed{false};
+  ContextBase* m_parent{nullptr};
+  // Non-zero for children added with AddChildContextInstance.
+  ContextHandle m_handle{0};
+
+  std::vector<PendingChildContext> m_pendingChildContexts;
+  // While set, responders for inherited signals are queued rather than
+  // attached, the parent's signals belong to another thread.
+  bool m_loadingAsync{false};
+  std::vector<type_identifier> m_pendingSignalAttachments;
+
+  std::vector<ChildSlot> m_childSlots;
+  std::vector<std::uint32_t> m_freeChildSlots;
+  std::unordered_map<type_identifier,
+                     std::vector<std::shared_ptr<ContextBase>>>
+      m_childContextPools;
+
+  std::vector<TickStep> m_tickOrder;
+  bool m_tickOrderDirty{true};
+
+  bool m_isolated{false};
+  // Set when a change inside this isolated child needs the ancestors' caches
+  // invalidated, which waits for the sync point.
+  bool m_invalidateAncestorsAtSync{false};
+  std::shared_ptr<WorkStealingPool> m_pWorkerPool;
 
   ResolverMap m_resolverMap;
   InstanceMap m_instanceMap;
+
+  // Resolve reads the published table without locking. Building, recycling,
+  // binding, storing and adding or removing children hold the mutation lock,
+  // so they are serialised with each other and with lazy singleton creation.
+  ThreadingPolicy::Atomic<const ResolutionTable*> m_pResolutionTable{nullptr};
+  std::vector<std::shared_ptr<const ResolutionTable>> m_resolutionTables;
+  mutable ThreadingPolicy::RecursiveMutex m_mutationMutex;
   UpdatableObjects m_updatableObjects;
 
   std::vector<std::function<void()>> m_preUpdateList;
   std::vector<std::function<void()>> m_postUpdateList;
   std::vector<std::function<void(const void*)>> m_eventHandlingList;
   std::vector<std::function<void(double)>> m_updateList;
+  std::vector<UpdateSchedule> m_updateSchedules;
+  unsigned int m_reducedRateSlots{0};
+  std::uint64_t m_frameIndex{0};
 
   std::vector<type_identifier> m_toRemoveUpdatableObjects;
   CommandMap m_commandMap;
   StoredObjects m_storedObjects;
-  StoredObjects m_sharedStoredObjects;
   std::vector<type_identifier> m_toRemoveStoredObjects;
-  std::vector<type_identifier> m_toRemoveSharedStoredObjects;
+  std::unordered_map<type_identifier, std::unique_ptr<KeyedStoreBase>>
+      m_keyedStores;
+  std::vector<KeyedStoreBase*> m_toApplyKeyedRemovals;
   CommandResolverMap m_commandResolverMap;
 
   std::unordered_map<type_identifier, std::vector<type_identifier>>
       m_attachedCommands;
 
   std::vector<type_identifier> asSingletonKeys;
+
+  // One per ToSnapshotted binding, run at the end of PostUpdateSelf.
+  std::vector<void (*)(ContextBase&)> m_snapshotPublishers;
+
+  // Resolved once at Initialise so the update phases skip the lookups.
+  std::shared_ptr<EnterContextSignal> m_pEnterSignal;
+  std::shared_ptr<ExitContextSignal> m_pExitSignal;
+  std::shared_ptr<PreUpdateContextSignal> m_pPreUpdateSignal;
+  std::shared_ptr<UpdateContextSignal> m_pUpdateSignal;
+  std::shared_ptr<PostUpdateContextSignal> m_pPostUpdateSignal;
+
+  // Only the context that bound the scheduler runs it, children share it.
+  std::shared_ptr<FrameScheduler> m_pFrameScheduler;
+
+  // Owned and run by the root. Descendants only point at it, so nothing the
+  // reclaimer holds can keep it alive.
+  std::unique_ptr<Reclaimer> m_pOwnedReclaimer;
+  Reclaimer* m_pReclaimer{nullptr};
+
+  // Created by the root, which commits it once the tree has post-updated.
+  std::shared_ptr<SharedStore> m_pSharedStore;
+  bool m_ownsSharedStore{false};
+
+  // Signals this context created, with their type names for metrics.
+  std::vector<std::pair<type_identifier, const char*>> m_signalTypes;
+  std::unordered_map<type_identifier, std::size_t> m_storedObjectSizes;
+
+  std::unordered_map<type_identifier, std::vector<EventSubscription>>
+      m_eventSubscriptions;
+  std::unordered_map<type_identifier, std::shared_ptr<const EventRoute>>
+      m_eventRoutes;
+  std::size_t m_nextEventToken{1};
+
+  MetricCounter m_singletonResolves;
+  MetricCounter m_transientResolves;
+  MetricCounter m_childContextsCreated;
+  MetricCounter m_childContextsDestroyed;
+  MetricCounter m_storedBytes;
 };
 
 // ----- Facades ----- //
@@ -254,6 +664,20 @@ class BindFacade {
         std::forward<Args>(args)...);
   }
 
+  // A singleton that is also copied into a Snapshotted<Key> at the end of
+  // every PostUpdate, for other threads to read.
+  template <class Value, class... Dependencies, class... Args>
+  void ToSnapshotted(Args&&... args) {
+    static_assert(std::is_same<Key, Value>(),
+                  "Snapshots copy the model, so bind it to its own type");
+    static_assert(std::is_copy_constructible<Value>() &&
+                      std::is_copy_assignable<Value>(),
+                  "Snapshotted models must be copyable");
+
+    _context.ToSnapshotted<Key, Value, Dependencies...>(
+        std::forward<Args>(args)...);
+  }
+
  private:
   ContextBase& _context;
 };
@@ -326,7 +750,7 @@ BindFacade<Key> ContextBase::Bind() {
   assert((ignore_result("Attempting to bind already bound key."),
           m_resolverMap.count(keyID) == 0));
 
-  m_resolverMap.insert(std::make_pair(keyID, nullptr));
+  m_resolverMap.insert(std::make_pair(keyID, Resolver{}));
 
   return BindFacade<Key>(*this);
 }
@@ -340,19 +764,25 @@ void ContextBase::BindSignal() {
           m_resolverMap.count(signalID) == 0));
 
   asSingletonKeys.push_back(signalID);
+  m_signalTypes.emplace_back(signalID, typeid(Key).name());
 
-  CreatorFunction del = [this, signalID]() -> std::shared_ptr<Key> {
-    const auto instanceFind = m_instanceMap.find(signalID);
-    if (instanceFind != m_instanceMap.end()) {
+  auto del = [signalID](ContextBase& owner) -> std::shared_ptr<Key> {
+    const auto instanceFind = owner.m_instanceMap.find(signalID);
+    if (instanceFind != owner.m_instanceMap.end()) {
       return std::static_pointer_cast<Key>(instanceFind->second);
     }
     std::shared_ptr<Key> signal = std::make_shared<Key>();
-    m_instanceMap.insert(std::make_pair(signalID, signal));
+    signal->SetOwner(&owner);
+    owner.m_instanceMap.insert(std::make_pair(signalID, signal));
+    if constexpr (is_statically_wired<Key>::value) {
+      signal->Wire(owner);
+    }
     return signal;
   };
 
   m_resolverMap.insert(std::make_pair(
-      signalID, std::make_shared<CreatorFunction>(std::move(del))));
+      signalID,
+      Resolver{std::make_shared<const CreatorFunction>(std::move(del)), this}));
 }
 
 template <class Key, class Value, class... Dependencies, class... Args>
@@ -372,11 +802,13 @@ void ContextBase::To(Args&&... args) {
                 "manually bound.");
   assert((ignore_result("Key not found."), m_resolverMap.count(keyID) > 0));
 
-  auto del = [this, args...]() -> std::shared_ptr<Value> {
-    return std::make_shared<Value>(this->Resolve<Dependencies>()..., args...);
+  auto del = [args...](ContextBase& owner) -> std::shared_ptr<Value> {
+    return std::make_shared<Value>(
+        owner.ResolveDependency<Dependencies>()..., args...);
   };
 
-  m_resolverMap[keyID] = std::make_shared<CreatorFunction>(std::move(del));
+  m_resolverMap[keyID] =
+      Resolver{std::make_shared<const CreatorFunction>(std::move(del)), this};
 }
 
 template <class Key, class Value, class... Dependencies, class... Args>
@@ -398,14 +830,28 @@ void ContextBase::ToSingleton(Args&&... args) {
 
   asSingletonKeys.push_back(keyID);
 
-  auto del = [this, keyID, args...]() -> std::shared_ptr<Value> {
-    m_instanceMap.insert(std::make_pair(
+  auto del = [keyID, args...](ContextBase& owner) -> std::shared_ptr<Value> {
+    owner.m_instanceMap.insert(std::make_pair(
         keyID,
-        std::make_shared<Value>(this->Resolve<Dependencies>()..., args...)));
+        std::make_shared<Value>(owner.ResolveDependency<Dependencies>()...,
+                                args...)));
     return nullptr;
   };
 
-  m_resolverMap[keyID] = std::make_shared<CreatorFunction>(std::move(del));
+  m_resolverMap[keyID] =
+      Resolver{std::make_shared<const CreatorFunction>(std::move(del)), this};
+}
+
+template <class Key, class Value, class... Dependencies, class... Args>
+void ContextBase::ToSnapshotted(Args&&... args) {
+  ToSingleton<Key, Value, Dependencies...>(std::forward<Args>(args)...);
+  Bind<Snapshotted<Key>>().template ToSingleton<Snapshotted<Key>>();
+  m_snapshotPublishers.push_back(&ContextBase::PublishSnapshot<Key>);
+}
+
+template <class Key>
+void ContextBase::PublishSnapshot(ContextBase& context) {
+  context.Resolve<Snapshotted<Key>>()->Publish(*context.Resolve<Key>());
 }
 
 template <class Key>
@@ -417,16 +863,33 @@ void ContextBase::RemoveBind() {
   m_commandMap.erase(bindID);
 }
 
+template <class Key>
+void ContextBase::BindCreator(std::shared_ptr<Key> (*create)(ContextBase&)) {
+  assert(create != nullptr);
+  const auto bound = m_resolverMap.find(UniqueKeyGenerator::Get<Key>());
+  if (bound != m_resolverMap.end() && bound->second.owner != this) {
+    RemoveBind<Key>();
+  }
+  Bind<Key>();
+
+  m_resolverMap[UniqueKeyGenerator::Get<Key>()] =
+      Resolver{std::make_shared<const CreatorFunction>(create), this};
+}
+
 template <class Signal>
 OnSignalFacade<Signal> ContextBase::On() {
   const auto signalID = UniqueKeyGenerator::Get<Signal>();
 
   static_assert(std::is_base_of<SignalBase, Signal>(),
                 "Attempting to use 'On' with non-Signal type.");
+  static_assert(!is_statically_wired<Signal>(),
+                "Attempting to use 'On' with a StaticSignal: its commands are "
+                "part of its type, bind it with 'BindSignal()'");
 
   // no signals of this type in resolver map
   if (m_resolverMap.count(signalID) == 0) {
     asSingletonKeys.push_back(signalID);
+    m_signalTypes.emplace_back(signalID, typeid(Signal).name());
     // add a signal responder to the command map, this is storage for attached
     // method to signal
     m_commandMap.insert(std::make_pair(
@@ -434,24 +897,26 @@ OnSignalFacade<Signal> ContextBase::On() {
                       m_resolverMap, m_commandResolverMap, signalID)));
 
     // create the resolver for this signal type
-    auto del = [this, signalID]() -> std::shared_ptr<Signal> {
-      const auto instanceFind = m_instanceMap.find(signalID);
-      if (instanceFind != m_instanceMap.end()) {
+    auto del = [signalID](ContextBase& owner) -> std::shared_ptr<Signal> {
+      const auto instanceFind = owner.m_instanceMap.find(signalID);
+      if (instanceFind != owner.m_instanceMap.end()) {
         return std::static_pointer_cast<Signal>(instanceFind->second);
       }
 
       std::shared_ptr<Signal> signal = std::make_shared<Signal>();
+      signal->SetOwner(&owner);
       // attach a signal responder
-      const auto findResult = m_commandMap.find(signalID);
+      const auto findResult = owner.m_commandMap.find(signalID);
       if (findResult->second) {
         signal->Attach(static_cast<SignalResponder*>(findResult->second.get()),
                        &SignalResponder::Respond);
       }
-      m_instanceMap.insert(std::make_pair(signalID, signal));
+      owner.m_instanceMap.insert(std::make_pair(signalID, signal));
       return signal;
     };
 
-    m_resolverMap[signalID] = std::make_shared<CreatorFunction>(std::move(del));
+    m_resolverMap[signalID] =
+        Resolver{std::make_shared<const CreatorFunction>(std::move(del)), this};
   } else  // this signal exists already and has a resolver
   {
     // Make and insert a new signal responder to the command map
@@ -460,19 +925,7 @@ OnSignalFacade<Signal> ContextBase::On() {
                       m_resolverMap, m_commandResolverMap, signalID)));
     const auto findResult = m_commandMap.find(signalID);
     if (findResult->second) {
-      // resolve the signal
-      const auto& signalCreatorFunction = *m_resolverMap.at(signalID);
-      const auto triggeringSignal =
-          std::static_pointer_cast<SignalBase>(signalCreatorFunction());
-
-      // attach the new signal responder to it
-      const auto attachID = triggeringSignal->Attach(
-          static_cast<SignalResponder*>(findResult->second.get()),
-          &SignalResponder::Respond);
-
-      // track that we have attached a command chain to this signal in case this
-      // context can be dynamically removed
-      m_attachedCommands[signalID].push_back(attachID);
+      AttachToInheritedSignal(signalID);
     }
   }
 
@@ -503,7 +956,12 @@ bool ContextBase::HasBinding() const {
 
 template <class Key>
 std::shared_ptr<Key> ContextBase::Resolve() {
-  return Resolve<Key>(UniqueKeyGenerator::Get<remove_const_t<Key>>());
+  auto resolved = TryResolve<Key>();
+  if (!resolved) {
+    throw std::runtime_error("No resolve available for : " +
+                             std::string(typeid(Key).name()));
+  }
+  return resolved;
 }
 
 template <>
@@ -512,31 +970,117 @@ std::shared_ptr<ContextBase> ContextBase::Resolve<ContextBase>() {
 }
 
 template <class Key>
-std::shared_ptr<Key> ContextBase::Resolve(type_identifier keyID) {
+std::shared_ptr<Key> ContextBase::TryResolve() {
+  if constexpr (std::is_same<remove_const_t<Key>, ContextBase>::value) {
+    return shared_from_this();
+  } else {
+    return TryResolve<Key>(UniqueKeyGenerator::Get<remove_const_t<Key>>());
+  }
+}
+
+template <class Key>
+std::shared_ptr<Key> ContextBase::TryResolve(type_identifier keyID) {
+  CULPRIT_ALLOCATION_SCOPE(Resolve);
+  const auto* table = m_pResolutionTable.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    if (const auto* entry = table->Find(keyID)) {
+      if (entry->instance != nullptr) {
+        m_singletonResolves.Add();
+        return std::static_pointer_cast<Key>(*entry->instance);
+      }
+      if (!entry->singleton) {
+        CULPRIT_PROFILE_SCOPE("Resolve", typeid(Key).name());
+        m_transientResolves.Add();
+        return std::static_pointer_cast<Key>((*entry->resolver)());
+      }
+    }
+  }
+
+  return ResolveLocked<Key>(keyID);
+}
+
+template <class Key>
+std::shared_ptr<Key> ContextBase::ResolveLocked(type_identifier keyID) {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   // <Key> is a singleton and there is an instance in the map. Return it
   const auto instance_iterator = m_instanceMap.find(keyID);
   if (instance_iterator != m_instanceMap.end()) {
+    m_singletonResolves.Add();
     return std::static_pointer_cast<Key>(instance_iterator->second);
   }
 
+  CULPRIT_PROFILE_SCOPE("Resolve", typeid(Key).name());
+
   const auto resolver_iterator = m_resolverMap.find(keyID);
   if (resolver_iterator != m_resolverMap.end()) {
-    const auto& instance_factory_function = *resolver_iterator->second;
+    const auto& instance_factory_function = resolver_iterator->second;
     if (std::find(asSingletonKeys.begin(), asSingletonKeys.end(), keyID) !=
         asSingletonKeys.end()) {
       // <Key> is a singleton, but there was no instance in the map. Create one,
       // store it in the map, and return it.
       instance_factory_function();
-      return std::static_pointer_cast<Key>(m_instanceMap.at(keyID));
+      m_singletonResolves.Add();
+      auto instance = std::static_pointer_cast<Key>(m_instanceMap.at(keyID));
+      if (m_pResolutionTable.load(std::memory_order_relaxed) != nullptr) {
+        PublishResolutionTable();
+      }
+      return instance;
     }
 
     // <Key> is not a singleton. Create one and return it
+    m_transientResolves.Add();
     return std::static_pointer_cast<Key>(instance_factory_function());
   }
 
-  std::string name = typeid(Key).name();
-  throw std::runtime_error("No resolve available for : " +
-                           std::string(typeid(Key).name()));
+  return nullptr;
+}
+
+template <class T>
+Borrowed<T> ContextBase::ResolveRef() {
+  using Key = remove_const_t<T>;
+  if constexpr (std::is_same<Key, ContextBase>::value) {
+    return Borrowed<T>(*this, shared_from_this());
+  } else {
+    const auto keyID = UniqueKeyGenerator::Get<Key>();
+    const auto* table = m_pResolutionTable.load(std::memory_order_acquire);
+    const auto* entry = table != nullptr ? table->Find(keyID) : nullptr;
+    if (entry != nullptr && entry->instance != nullptr) {
+      m_singletonResolves.Add();
+      return Borrowed<T>(*static_cast<Key*>(entry->instance->get()),
+                         *entry->instance);
+    }
+
+    std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+    auto instance = m_instanceMap.find(keyID);
+    if (instance == m_instanceMap.end()) {
+      if (m_resolverMap.count(keyID) == 0) {
+        throw std::runtime_error("No resolve available for : " +
+                                 std::string(typeid(Key).name()));
+      }
+      if (std::find(asSingletonKeys.begin(), asSingletonKeys.end(), keyID) ==
+          asSingletonKeys.end()) {
+        throw std::runtime_error("Cannot borrow non-singleton binding : " +
+                                 std::string(typeid(Key).name()));
+      }
+
+      TryResolve<Key>(keyID);
+      instance = m_instanceMap.find(keyID);
+    } else {
+      m_singletonResolves.Add();
+    }
+
+    return Borrowed<T>(*static_cast<Key*>(instance->second.get()),
+                       instance->second);
+  }
+}
+
+template <class Dependency>
+decltype(auto) ContextBase::ResolveDependency() {
+  if constexpr (is_borrowed_dependency<Dependency>::value) {
+    return ResolveRef<typename Dependency::type>();
+  } else {
+    return Resolve<Dependency>();
+  }
 }
 
 template <class Dependencies, class... Args>
@@ -552,7 +1096,7 @@ decltype(auto) ContextBase::Expand(creator<Dependencies...>, Args&&... args) {
 
 template <class Value, class... Dependencies, class... Args>
 decltype(auto) ContextBase::DoResolveInPlace(Args&&... args) {
-  return std::make_shared<Value>((Resolve<Dependencies>())...,
+  return std::make_shared<Value>((ResolveDependency<Dependencies>())...,
                                  std::forward<Args>(args)...);
 }
 
@@ -562,14 +1106,13 @@ void ContextBase::BindCommand(Args&&... args) {
 
   // if we don't know how create this command then make a new resolver
   if (m_commandResolverMap.find(commandID) == m_commandResolverMap.end()) {
-    m_commandResolverMap.insert(std::make_pair(commandID, nullptr));
-
-    auto del = [this, args...]() -> std::shared_ptr<Key> {
-      return std::make_shared<Key>(Resolve<Dependencies>()..., args...);
+    auto del = [args...](ContextBase& owner) -> std::shared_ptr<Key> {
+      return std::make_shared<Key>(owner.ResolveDependency<Dependencies>()...,
+                                   args...);
     };
 
     m_commandResolverMap[commandID] =
-        std::make_shared<CreatorFunction>(std::move(del));
+        Resolver{std::make_shared<const CreatorFunction>(std::move(del)), this};
   }
 }
 
@@ -581,39 +1124,157 @@ decltype(auto) ContextBase::Create(Args&&... args) {
 
 template <class Context>
 std::shared_ptr<Context> ContextBase::AddChildContext() {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   const auto contextKey = UniqueKeyGenerator::Get<Context>();
 
   static_assert(std::is_base_of<ContextBase, Context>(),
                 "Child context must be ContextBase type");
   assert((ignore_result("Cannot add the same child context twice."),
-          m_childContexts.count(contextKey) == 0));
+          FindChildContext(contextKey) == m_childContexts.end()));
 
   auto child = std::make_shared<Context>();
   child->PopulateFromParent(*this);
   child->Initialise();
-  m_childContexts.insert(std::make_pair(contextKey, child));
+  child->m_parent = this;
+  m_childContexts.emplace_back(contextKey, child);
+  InvalidateTraversalCaches();
+  m_childContextsCreated.Add();
+  return child;
+}
+
+template <class Context>
+std::future<std::shared_ptr<Context>> ContextBase::AddChildContextAsync() {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  static_assert(std::is_base_of<ContextBase, Context>(),
+                "Child context must be ContextBase type");
+
+  auto child = std::make_shared<Context>();
+  child->PopulateFromParent(*this);
+  child->m_loadingAsync = true;
+
+  auto promise = std::make_shared<std::promise<std::shared_ptr<Context>>>();
+  auto future = promise->get_future();
+  QueueChildContextLoad(
+      UniqueKeyGenerator::Get<Context>(), child,
+      [promise, child](std::exception_ptr error) {
+        if (error) {
+          promise->set_exception(error);
+        } else {
+          promise->set_value(child);
+        }
+      });
+  return future;
+}
+
+template <class Context>
+ContextHandle ContextBase::AddChildContextInstance() {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  const auto contextKey = UniqueKeyGenerator::Get<Context>();
+
+  static_assert(std::is_base_of<ContextBase, Context>(),
+                "Child context must be ContextBase type");
+
+  auto child = TakePooledChildContext(contextKey);
+  if (!child) {
+    child = std::make_shared<Context>();
+    child->PopulateFromParent(*this);
+    child->Initialise();
+  }
+
+  m_childContextsCreated.Add();
+  return AttachChildContextInstance(contextKey, std::move(child));
+}
+
+template <class Context>
+std::shared_ptr<Context> ContextBase::GetChildContext(
+    ContextHandle handle) const {
+  auto child = TryGetChildContext<Context>(handle);
+  if (!child) {
+    throw std::runtime_error("No child context of type " +
+                             std::string(typeid(Context).name()) +
+                             " with handle " + std::to_string(handle));
+  }
+
   return child;
 }
 
+template <class Context>
+std::shared_ptr<Context> ContextBase::TryGetChildContext(
+    ContextHandle handle) const {
+  const auto slot = FindChildSlot(handle);
+  if (slot == nullptr || slot->type != static_cast<type_identifier>(
+                               UniqueKeyGenerator::Get<Context>())) {
+    return nullptr;
+  }
+
+  return std::static_pointer_cast<Context>(slot->context);
+}
+
+template <class Context>
+void ContextBase::ReserveChildContexts(std::size_t count) {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  static_assert(std::is_base_of<ContextBase, Context>(),
+                "Child context must be ContextBase type");
+
+  auto& pool = m_childContextPools[UniqueKeyGenerator::Get<Context>()];
+  for (std::size_t i = 0; i < count; ++i) {
+    auto child = std::make_shared<Context>();
+    child->PopulateFromParent(*this);
+    child->Initialise();
+    pool.push_back(std::move(child));
+  }
+}
+
+template <class Context>
+std::size_t ContextBase::GetPooledChildContextCount() const {
+  const auto pool =
+      m_childContextPools.find(UniqueKeyGenerator::Get<Context>());
+  return pool == m_childContextPools.end() ? 0 : pool->second.size();
+}
+
 template <class Context>
 std::shared_ptr<Context> ContextBase::GetChildContext() const {
-  auto storedResult = m_childContexts.find(UniqueKeyGenerator::Get<Context>());
-  if (storedResult == m_childContexts.end()) {
+  auto child = TryGetChildContext<Context>();
+  if (!child) {
     throw std::runtime_error("No child context of type " +
                              std::string(typeid(Context).name()));
   }
 
+  return child;
+}
+
+template <class Context>
+std::shared_ptr<Context> ContextBase::TryGetChildContext() const {
+  auto storedResult =
+      FindChildContext(UniqueKeyGenerator::Get<Context>());
+  if (storedResult == m_childContexts.end()) {
+    return nullptr;
+  }
+
   return std::static_pointer_cast<Context>(storedResult->second);
 }
 
+template <class Context>
+Borrowed<Context> ContextBase::GetChildContextRef() const {
+  auto storedResult = FindChildContext(UniqueKeyGenerator::Get<Context>());
+  if (storedResult == m_childContexts.end()) {
+    throw std::runtime_error("No child context of type " +
+                             std::string(typeid(Context).name()));
+  }
+
+  return Borrowed<Context>(*static_cast<Context*>(storedResult->second.get()),
+                           storedResult->second);
+}
+
 template <class Context>
 bool ContextBase::RemoveChildContext() {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   const auto contextKey = UniqueKeyGenerator::Get<Context>();
 
   static_assert(std::is_base_of<ContextBase, Context>(),
                 "Child context must be ContextBase type");
 
-  auto contextResult = m_childContexts.find(contextKey);
+  auto contextResult = FindChildContext(contextKey);
   if (contextResult == m_childContexts.end()) {
     return false;
   }
@@ -621,17 +1282,31 @@ bool ContextBase::RemoveChildContext() {
   contextResult->second->Exit();
 
   for (auto& child : contextResult->second->m_childContexts) {
+    if (!child.second) {
+      continue;
+    }
     std::cout << "Context of type " << std::string(typeid(child).name())
               << " was not removed" << std::endl;
     child.second->Exit();
   }
 
-  m_childContexts.erase(contextKey);
+  auto removed = contextResult->second;
+  removed->m_parent = nullptr;
+  removed->MarkRemoved();
+  removed->ForgetReclaimer();
+  EraseChildContext(contextResult);
+  InvalidateTraversalCaches();
+  m_childContextsDestroyed.Add();
+
+  // Its teardown happens in the reclaimer rather than here.
+  Retire(std::move(removed));
   return true;
 }
 
 template <class Key, const type_identifier N>
 void ContextBase::Store(std::shared_ptr<Key> value) {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   static_assert(!std::is_base_of<CommandBase, Key>(),
                 "Cannot store Command type");
   static_assert(!std::is_base_of<SignalBase, Key>(),
@@ -648,12 +1323,18 @@ void ContextBase::Store(std::shared_ptr<Key> value) {
               "Key Type is singleton, but does not match bound singleton."),
           store_is_valid));
 
-  m_storedObjects.insert(std::make_pair(
-      UniqueKeyGenerator::Get<store_key<Key, N>>(), std::move(value)));
+  const auto storedKey = UniqueKeyGenerator::Get<store_key<Key, N>>();
+  if (m_storedObjects.insert(std::make_pair(storedKey, std::move(value)))
+          .second) {
+    m_storedObjectSizes[storedKey] = sizeof(Key);
+    m_storedBytes.Add(sizeof(Key));
+  }
 }
 
 template <class Key, const type_identifier N>
 void ContextBase::StoreShared(std::shared_ptr<Key> value) {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   static_assert(!std::is_base_of<CommandBase, Key>(),
                 "Cannot store Command type");
   static_assert(!std::is_base_of<SignalBase, Key>(),
@@ -670,36 +1351,66 @@ void ContextBase::StoreShared(std::shared_ptr<Key> value) {
               "Key Type is singleton, but does not match bound singleton."),
           store_is_valid));
 
-  m_sharedStoredObjects.insert(std::make_pair(
-      UniqueKeyGenerator::Get<store_key<Key, N>>(), std::move(value)));
+  m_pSharedStore->Put(UniqueKeyGenerator::Get<store_key<Key, N>>(),
+                      std::move(value));
 }
 
 template <class Key, const type_identifier N>
 decltype(auto) ContextBase::GetFromStore() {
+  auto stored = TryGetFromStore<Key, N>();
+  if (!stored) {
+    throw std::runtime_error("No stored object of type " +
+                             std::string(typeid(Key).name()));
+  }
+
+  return stored;
+}
+
+template <class Key, const type_identifier N>
+decltype(auto) ContextBase::GetFromSharedStore() {
+  auto stored = TryGetFromSharedStore<Key, N>();
+  if (!stored) {
+    throw std::runtime_error("No stored object of type " +
+                             std::string(typeid(Key).name()));
+  }
+
+  return stored;
+}
+
+template <class Key, const type_identifier N>
+std::shared_ptr<Key> ContextBase::TryGetFromStore() {
   auto storedResult =
       m_storedObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
   if (storedResult == m_storedObjects.end()) {
-    throw std::runtime_error("No stored object of type " +
-                             std::string(typeid(Key).name()));
+    return nullptr;
   }
 
   return std::static_pointer_cast<Key>(storedResult->second);
 }
 
 template <class Key, const type_identifier N>
-decltype(auto) ContextBase::GetFromSharedStore() {
+std::shared_ptr<Key> ContextBase::TryGetFromSharedStore() {
+  return std::static_pointer_cast<Key>(m_pSharedStore->FindStaged(
+      UniqueKeyGenerator::Get<store_key<Key, N>>()));
+}
+
+template <class Key, const type_identifier N>
+Borrowed<Key> ContextBase::GetFromStoreRef() {
   auto storedResult =
-      m_sharedStoredObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
-  if (storedResult == m_sharedStoredObjects.end()) {
+      m_storedObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
+  if (storedResult == m_storedObjects.end()) {
     throw std::runtime_error("No stored object of type " +
                              std::string(typeid(Key).name()));
   }
 
-  return std::static_pointer_cast<Key>(storedResult->second);
+  return Borrowed<Key>(*static_cast<Key*>(storedResult->second.get()),
+                       storedResult->second);
 }
 
 template <class Key, const type_identifier N>
 void ContextBase::DeleteFromStore() {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
   auto storedResult =
       m_storedObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
   if (storedResult == m_storedObjects.end()) {
@@ -713,15 +1424,79 @@ void ContextBase::DeleteFromStore() {
 
 template <class Key, const type_identifier N>
 void ContextBase::DeleteFromSharedStore() {
-  auto storedResult =
-      m_sharedStoredObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
-  if (storedResult == m_sharedStoredObjects.end()) {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  const auto storedKey = UniqueKeyGenerator::Get<store_key<Key, N>>();
+  if (!m_pSharedStore->FindStaged(storedKey)) {
     throw std::runtime_error("No stored object of type " +
                              std::string(typeid(Key).name()));
   }
 
-  m_toRemoveSharedStoredObjects.insert(
-      UniqueKeyGenerator::Get<store_key<Key, N>>());
+  m_pSharedStore->Remove(storedKey);
+}
+
+template <class Key>
+void ContextBase::StoreKeyed(KeyedId id, Key value) {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  if (GetKeyedStore<Key>().Put(id, std::move(value))) {
+    m_storedBytes.Add(sizeof(Key));
+  }
+}
+
+template <class Key>
+Key& ContextBase::GetKeyed(KeyedId id) {
+  auto stored = TryGetKeyed<Key>(id);
+  if (!stored) {
+    throw std::runtime_error("No keyed object " + std::to_string(id) +
+                             " of type " + std::string(typeid(Key).name()));
+  }
+
+  return *stored;
+}
+
+template <class Key>
+Key* ContextBase::TryGetKeyed(KeyedId id) {
+  const auto store = m_keyedStores.find(UniqueKeyGenerator::Get<Key>());
+  if (store == m_keyedStores.end()) {
+    return nullptr;
+  }
+
+  return static_cast<KeyedStore<Key>*>(store->second.get())->Find(id);
+}
+
+template <class Key>
+bool ContextBase::HasKeyed(KeyedId id) {
+  return TryGetKeyed<Key>(id) != nullptr;
+}
+
+template <class Key>
+void ContextBase::DeleteKeyed(KeyedId id) {
+  CULPRIT_ALLOCATION_SCOPE(Store);
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  if (!HasKeyed<Key>(id)) {
+    throw std::runtime_error("No keyed object " + std::to_string(id) +
+                             " of type " + std::string(typeid(Key).name()));
+  }
+
+  auto& store = GetKeyedStore<Key>();
+  store.Remove(id);
+  m_toApplyKeyedRemovals.push_back(&store);
+}
+
+template <class Key>
+KeyedStore<Key>& ContextBase::GetKeyedStore() {
+  static_assert(!std::is_base_of<CommandBase, Key>(),
+                "Cannot store Command type");
+  static_assert(!std::is_base_of<SignalBase, Key>(),
+                "Cannot store Signal type");
+  static_assert(!std::is_base_of<ContextBase, Key>(),
+                "Cannot store Context type");
+  auto& store = m_keyedStores[UniqueKeyGenerator::Get<Key>()];
+  if (!store) {
+    store = std::make_unique<KeyedStore<Key>>();
+  }
+
+  return *static_cast<KeyedStore<Key>*>(store.get());
 }
 
 template <class Key, const type_identifier N>
@@ -733,9 +1508,8 @@ bool ContextBase::HasStored() {
 
 template <class Key, const type_identifier N>
 bool ContextBase::HasSharedStored() {
-  auto storedResult =
-      m_sharedStoredObjects.find(UniqueKeyGenerator::Get<store_key<Key, N>>());
-  return storedResult != m_sharedStoredObjects.end();
+  return m_pSharedStore->FindStaged(
+             UniqueKeyGenerator::Get<store_key<Key, N>>()) != nullptr;
 }
 
 template <class Key>
@@ -746,17 +1520,34 @@ bool ContextBase::HasUpdatable() {
 }
 
 template <class Key>
-void ContextBase::AddUpdatable(std::shared_ptr<Key> value) {
+void ContextBase::AddUpdatable(std::shared_ptr<Key> value, UpdateRate rate) {
   static_assert(std::is_base_of<IUpdatable<Key>, Key>(),
                 "Attempting to use 'AddUpdatable' with non-Updatable type.");
   assert((ignore_result("Attempting to bind already bound key."),
           m_updatableObjects.count(UniqueKeyGenerator::Get<Key>()) == 0));
 
-  m_preUpdateList.push_back([value]() { value->doPreUpdate(); });
-  m_updateList.push_back([value](double delta) { value->doUpdate(delta); });
+  m_preUpdateList.push_back([value]() {
+    CULPRIT_PROFILE_SCOPE("PreUpdate", typeid(Key).name());
+    CULPRIT_ALLOCATION_SCOPE(Updatable);
+    value->doPreUpdate();
+  });
+  m_updateList.push_back([value](double delta) {
+    CULPRIT_PROFILE_SCOPE("Update", typeid(Key).name());
+    CULPRIT_ALLOCATION_SCOPE(Updatable);
+    value->doUpdate(delta);
+  });
   m_eventHandlingList.push_back(
-      [value](const void* pEvent) { value->doHandleEvents(pEvent); });
-  m_postUpdateList.push_back([value] { value->doPostUpdate(); });
+      [value](const void* pEvent) {
+        CULPRIT_ALLOCATION_SCOPE(Updatable);
+        value->doHandleEvents(pEvent);
+      });
+  m_postUpdateList.push_back([value] {
+    CULPRIT_PROFILE_SCOPE("PostUpdate", typeid(Key).name());
+    CULPRIT_ALLOCATION_SCOPE(Updatable);
+    value->doPostUpdate();
+  });
+  m_updateSchedules.emplace_back(
+      rate, rate.IsEveryFrame() ? 0 : m_reducedRateSlots++);
 
   m_updatableObjects.insert(
       std::make_pair(UniqueKeyGenerator::Get<Key>(), std::make_pair(m_updateList.size() - 1, std::make_shared<UpdatableWrapper>(value))));
@@ -764,6 +1555,28 @@ void ContextBase::AddUpdatable(std::shared_ptr<Key> value) {
 
 template <class Key>
 decltype(auto) ContextBase::GetUpdatable() {
+  auto updatable = TryGetUpdatable<Key>();
+  if (!updatable) {
+    throw std::runtime_error("No stored updatable of type " +
+                             std::string(typeid(Key).name()));
+  }
+
+  return updatable;
+}
+
+template <class Key>
+std::shared_ptr<Key> ContextBase::TryGetUpdatable() {
+  auto updatableResult =
+      m_updatableObjects.find(UniqueKeyGenerator::Get<Key>());
+  if (updatableResult == m_updatableObjects.end()) {
+    return nullptr;
+  }
+
+  return updatableResult->second.second->Get<Key>();
+}
+
+template <class Key>
+Borrowed<Key> ContextBase::GetUpdatableRef() {
   auto updatableResult =
       m_updatableObjects.find(UniqueKeyGenerator::Get<Key>());
   if (updatableResult == m_updatableObjects.end()) {
@@ -771,7 +1584,8 @@ decltype(auto) ContextBase::GetUpdatable() {
                              std::string(typeid(Key).name()));
   }
 
-  return updatableResult->second.second->Get<Key>();
+  const auto& owner = updatableResult->second.second->GetOwner();
+  return Borrowed<Key>(*static_cast<Key*>(owner.get()), owner);
 }
 
 template <class Key>
@@ -784,6 +1598,78 @@ void ContextBase::RemoveUpdatable() {
   }
   m_toRemoveUpdatableObjects.push_back(UniqueKeyGenerator::Get<Key>());
 }
+
+template <class Key>
+void ContextBase::SetUpdatableActive(bool active) {
+  auto updatableResult =
+      m_updatableObjects.find(UniqueKeyGenerator::Get<Key>());
+  if (updatableResult == m_updatableObjects.end()) {
+    throw std::runtime_error("No stored updatable of type " +
+                             std::string(typeid(Key).name()));
+  }
+
+  m_updateSchedules[updatableResult->second.first].SetActive(active);
+  InvalidateTraversalCaches();
+}
+
+template <class Key>
+bool ContextBase::IsUpdatableActive() const {
+  auto updatableResult =
+      m_updatableObjects.find(UniqueKeyGenerator::Get<Key>());
+  if (updatableResult == m_updatableObjects.end()) {
+    throw std::runtime_error("No stored updatable of type " +
+                             std::string(typeid(Key).name()));
+  }
+
+  return m_updateSchedules[updatableResult->second.first].IsActive();
+}
+
+template <class Event>
+void ContextBase::HandleEvents(EventSpan<Event> events) {
+  if (events.empty()) {
+    return;
+  }
+
+  // Holding the route keeps it alive if a handler changes subscriptions,
+  // those changes apply from the next call.
+  const auto route = GetEventRoute(UniqueKeyGenerator::Get<Event>());
+  for (const auto& handler : *route) {
+    (*handler)(events.data(), events.size());
+  }
+}
+
+template <class Event>
+void ContextBase::HandleEvent(const Event& event) {
+  HandleEvents(EventSpan<Event>(&event, 1));
+}
+
+template <class Event, class Key>
+void ContextBase::SubscribeEvents() {
+  std::shared_ptr<Key> updatable = GetUpdatable<Key>();
+
+  auto handler = std::make_shared<EventHandler>(
+      [updatable](const void* events, std::size_t count) {
+        updatable->OnEvents(
+            EventSpan<Event>(static_cast<const Event*>(events), count));
+      });
+
+  AddEventSubscription(UniqueKeyGenerator::Get<Event>(),
+                       UniqueKeyGenerator::Get<Key>(), std::move(handler));
+}
+
+template <class Event>
+std::size_t ContextBase::SubscribeEvents(
+    std::function<void(EventSpan<Event>)> handler) {
+  assert(handler != nullptr);
+
+  auto eventHandler = std::make_shared<EventHandler>(
+      [handler = std::move(handler)](const void* events, std::size_t count) {
+        handler(EventSpan<Event>(static_cast<const Event*>(events), count));
+      });
+
+  return AddEventSubscription(UniqueKeyGenerator::Get<Event>(), 0,
+                              std::move(eventHandler));
+}
 // ----- End ContextBase ----- //
 
 }  // namespace framework
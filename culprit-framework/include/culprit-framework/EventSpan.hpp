@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace culprit {
+namespace framework {
+
+// A read-only view over a contiguous batch of events of one type.
+template <class Event>
+class EventSpan {
+ public:
+  EventSpan() = default;
+  EventSpan(const Event* events, std::size_t count)
+      : m_events{events}, m_count{count} {}
+  EventSpan(const std::vector<Event>& events)
+      : m_events{events.data()}, m_count{events.size()} {}
+
+  const Event* begin() const { return m_events; }
+  const Event* end() const { return m_events + m_count; }
+  const Event* data() const { return m_events; }
+  std::size_t size() const { return m_count; }
+  bool empty() const { return m_count == 0; }
+  const Event& operator[](std::size_t index) const { return m_events[index]; }
+
+ private:
+  const Event* m_events{nullptr};
+  std::size_t m_count{0};
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "ThreadingPolicy.h"
+
+namespace culprit {
+namespace framework {
+
+struct FrameSchedulerReport {
+  std::size_t jobsRun{0};
+  std::size_t jobsPending{0};
+  std::chrono::microseconds elapsed{0};
+  // Time spent past the budget, zero if the frame stayed within it.
+  std::chrono::microseconds overrun{0};
+  // Time the jobs run this frame spent waiting in the queue.
+  std::chrono::microseconds maxQueueLatency{0};
+  std::chrono::microseconds averageQueueLatency{0};
+};
+
+// Runs low priority jobs between Update and PostUpdate of the root context,
+// up to a per-frame time budget. Jobs that don't fit are carried over to the
+// next frame in the order they were scheduled. Schedule may be called from
+// any thread, e.g. by isolated contexts updating on a worker pool.
+class FrameScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Job = std::function<void()>;
+
+  explicit FrameScheduler(
+      std::chrono::microseconds frameBudget = std::chrono::microseconds{1000})
+      : m_frameBudget{frameBudget} {}
+
+  void Schedule(Job job);
+
+  void SetFrameBudget(std::chrono::microseconds frameBudget) {
+    m_frameBudget = frameBudget;
+  }
+  std::chrono::microseconds GetFrameBudget() const { return m_frameBudget; }
+
+  std::size_t GetPendingCount() const {
+    std::lock_guard<ThreadingPolicy::Mutex> lock(m_jobsMutex);
+    return m_jobs.size();
+  }
+  const FrameSchedulerReport& GetLastFrameReport() const {
+    return m_lastFrameReport;
+  }
+
+  // At least one job runs each frame so the queue always drains, even when a
+  // single job is larger than the budget. Jobs scheduled while running wait
+  // for the next frame.
+  void RunFrame();
+
+ private:
+  struct QueuedJob {
+    Job job;
+    Clock::time_point queuedAt;
+  };
+
+  mutable ThreadingPolicy::Mutex m_jobsMutex;
+  std::deque<QueuedJob> m_jobs;
+  std::chrono::microseconds m_frameBudget;
+  FrameSchedulerReport m_lastFrameReport;
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace culprit {
+namespace framework {
+
+using KeyedId = std::uint64_t;
+
+class KeyedStoreBase {
+ public:
+  virtual ~KeyedStoreBase() = default;
+
+  // Applies the removals queued with Remove, returns how many there were.
+  virtual std::size_t ApplyRemovals() = 0;
+  virtual void Clear() = 0;
+  virtual std::size_t size() const = 0;
+  virtual std::size_t GetValueSize() const = 0;
+};
+
+// Objects of one type kept by runtime id. The values sit contiguously in
+// insertion order, apart from removals which move the last value into the
+// gap, and an open addressing index with linear probing maps ids to them.
+//
+// Adding or removing may move values, so don't keep pointers across either.
+template <class T>
+class KeyedStore : public KeyedStoreBase {
+ public:
+  // Inserts, or replaces the value already stored for id. Returns true if it
+  // was inserted. Cancels a queued removal of id.
+  bool Put(KeyedId id, T value) {
+    if (T* existing = Find(id)) {
+      *existing = std::move(value);
+      CancelRemoval(id);
+      return false;
+    }
+
+    if ((m_ids.size() + 1) * kMaxLoadDenominator >
+        m_slots.size() * kMaxLoadNumerator) {
+      Rehash(m_slots.empty() ? kMinSlots : m_slots.size() * 2);
+    }
+
+    m_slots[FindSlot(id)] = Slot{id, static_cast<std::uint32_t>(m_ids.size())};
+    m_ids.push_back(id);
+    m_values.push_back(std::move(value));
+    return true;
+  }
+
+  T* Find(KeyedId id) {
+    if (m_slots.empty()) {
+      return nullptr;
+    }
+    const auto& slot = m_slots[FindSlot(id)];
+    return slot.index == kEmpty ? nullptr : &m_values[slot.index];
+  }
+
+  const T* Find(KeyedId id) const {
+    return const_cast<KeyedStore*>(this)->Find(id);
+  }
+
+  bool Contains(KeyedId id) const { return Find(id) != nullptr; }
+
+  // Queued until ApplyRemovals, until then the value is still found.
+  void Remove(KeyedId id) { m_removals.push_back(id); }
+
+  std::size_t ApplyRemovals() override {
+    std::size_t removed = 0;
+    for (const auto id : m_removals) {
+      removed += Erase(id) ? 1 : 0;
+    }
+    m_removals.clear();
+    return removed;
+  }
+
+  void Clear() override {
+    m_slots.clear();
+    m_ids.clear();
+    m_values.clear();
+    m_removals.clear();
+  }
+
+  std::size_t size() const override { return m_ids.size(); }
+  bool empty() const { return m_ids.empty(); }
+  std::size_t GetValueSize() const override { return sizeof(T); }
+
+  // Bulk access, ids()[i] is the id of values()[i].
+  T* begin() { return m_values.data(); }
+  T* end() { return m_values.data() + m_values.size(); }
+  const T* begin() const { return m_values.data(); }
+  const T* end() const { return m_values.data() + m_values.size(); }
+  const std::vector<KeyedId>& ids() const { return m_ids; }
+  std::vector<T>& values() { return m_values; }
+  const std::vector<T>& values() const { return m_values; }
+
+ private:
+  static constexpr std::uint32_t kEmpty = ~std::uint32_t{0};
+  static constexpr std::size_t kMinSlots = 16;
+  static constexpr std::size_t kMaxLoadNumerator = 3;
+  static constexpr std::size_t kMaxLoadDenominator = 4;
+
+  struct Slot {
+    KeyedId id{0};
+    std::uint32_t index{kEmpty};
+  };
+
+  std::size_t Home(KeyedId id) const {
+    // Fibonacci hashing, the top bits are the best mixed.
+    return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >>
+                                    m_shift);
+  }
+
+  // The slot holding id, or the empty slot where it would go.
+  std::size_t FindSlot(KeyedId id) const {
+    const auto mask = m_slots.size() - 1;
+    auto slot = Home(id);
+    while (m_slots[slot].index != kEmpty && m_slots[slot].id != id) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void Rehash(std::size_t slotCount) {
+    m_slots.assign(slotCount, Slot{});
+    m_shift = 64;
+    for (auto count = slotCount; count > 1; count >>= 1) {
+      --m_shift;
+    }
+    for (std::size_t i = 0; i < m_ids.size(); ++i) {
+      m_slots[FindSlot(m_ids[i])] =
+          Slot{m_ids[i], static_cast<std::uint32_t>(i)};
+    }
+  }
+
+  bool Erase(KeyedId id) {
+    if (m_slots.empty()) {
+      return false;
+    }
+    const auto mask = m_slots.size() - 1;
+    auto hole = FindSlot(id);
+    const auto index = m_slots[hole].index;
+    if (index == kEmpty) {
+      return false;
+    }
+
+    // Keep the values dense by moving the last one into the gap.
+    const auto last = static_cast<std::uint32_t>(m_ids.size() - 1);
+    if (index != last) {
+      m_slots[FindSlot(m_ids[last])].index = index;
+      m_ids[index] = m_ids[last];
+      m_values[index] = std::move(m_values[last]);
+    }
+    m_ids.pop_back();
+    m_values.pop_back();
+
+    // Backward shift, so lookups never need tombstones.
+    auto next = (hole + 1) & mask;
+    while (m_slots[next].index != kEmpty) {
+      const auto home = Home(m_slots[next].id);
+      if (((next - home) & mask) >= ((next - hole) & mask)) {
+        m_slots[hole] = m_slots[next];
+        hole = next;
+      }
+      next = (next + 1) & mask;
+    }
+    m_slots[hole] = Slot{};
+    return true;
+  }
+
+  void CancelRemoval(KeyedId id) {
+    for (auto& removal : m_removals) {
+      if (removal == id) {
+        removal = m_removals.back();
+        m_removals.pop_back();
+        return;
+      }
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  unsigned int m_shift{64};
+  std::vector<KeyedId> m_ids;
+  std::vector<T> m_values;
+  std::vector<KeyedId> m_removals;
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadingPolicy.h"
+
+namespace culprit {
+namespace framework {
+
+// A counter split over cache-line padded shards. Each thread always adds to
+// the same shard, so threads counting the same event don't bounce a cache
+// line between them. Reading sums the shards. Single threaded builds use one
+// plain shard.
+class MetricCounter {
+ public:
+  void Add(std::int64_t amount = 1) {
+    m_shards[ShardIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  std::int64_t Read() const {
+    std::int64_t total = 0;
+    for (const auto& shard : m_shards) {
+      total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+ private:
+  static constexpr std::size_t kShardCount =
+      ThreadingPolicy::IsSingleThreaded ? 1 : 8;
+
+  struct alignas(64) Shard {
+    ThreadingPolicy::Counter<std::int64_t> value{0};
+  };
+
+  static std::size_t ShardIndex() {
+    if constexpr (kShardCount == 1) {
+      return 0;
+    }
+    static std::atomic<std::size_t> nextIndex{0};
+    thread_local const std::size_t index =
+        nextIndex.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return index;
+  }
+
+  std::array<Shard, kShardCount> m_shards;
+};
+
+struct SignalMetrics {
+  const char* name{nullptr};
+  std::uint64_t dispatches{0};
+};
+
+struct ContextMetrics {
+  const char* name{nullptr};
+  std::size_t depth{0};
+  std::size_t updatables{0};
+};
+
+// Totals for a context and everything below it. Counts are cumulative, take
+// two snapshots and use the *PerSecond helpers for rates.
+struct MetricsSnapshot {
+  std::chrono::steady_clock::time_point takenAt;
+
+  std::uint64_t singletonResolves{0};
+  std::uint64_t transientResolves{0};
+
+  // One entry per signal type, summed over every context that owns one.
+  std::vector<SignalMetrics> signals;
+
+  std::uint64_t commandChainsStarted{0};
+  std::uint64_t commandsExecuted{0};
+  // Chains waiting on a command that has not called Release yet.
+  std::uint64_t pendingCommandChains{0};
+
+  std::vector<ContextMetrics> contexts;
+  std::uint64_t childContextsCreated{0};
+  std::uint64_t childContextsDestroyed{0};
+
+  // Sum of sizeof(Key) for objects in the context stores. Memory owned by the
+  // stored objects themselves is not included.
+  std::int64_t storedBytes{0};
+
+  double AverageChainLength() const {
+    return commandChainsStarted == 0
+               ? 0.0
+               : static_cast<double>(commandsExecuted) / commandChainsStarted;
+  }
+
+  double SingletonResolvesPerSecond(const MetricsSnapshot& earlier) const {
+    return PerSecond(singletonResolves - earlier.singletonResolves, earlier);
+  }
+
+  double TransientResolvesPerSecond(const MetricsSnapshot& earlier) const {
+    return PerSecond(transientResolves - earlier.transientResolves, earlier);
+  }
+
+ private:
+  double PerSecond(std::uint64_t count, const MetricsSnapshot& earlier) const {
+    const std::chrono::duration<double> elapsed = takenAt - earlier.takenAt;
+    return elapsed.count() > 0.0 ? count / elapsed.count() : 0.0;
+  }
+};
+
+}  // namespace framework
+}  // namespace culprit
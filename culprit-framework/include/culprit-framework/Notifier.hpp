@@ -7,12 +7,18 @@
 #include <iomanip>
 #include <vector>
 
+#include "ThreadingPolicy.h"
+
 namespace culprit {
 namespace framework {
 
 class Notifier {
  public:
-  virtual ~Notifier() = default;
+  virtual ~Notifier() {
+    if (pDestroyed != nullptr) {
+      *pDestroyed = true;
+    }
+  }
 
   template <class T>
   std::size_t Attach(T* instance, void (T::*memberFunction)()) {
@@ -21,11 +27,8 @@ class Notifier {
 
     const auto attachToken = GetAttachToken();
 
-    auto handler_ident =
-        std::make_tuple(static_cast<void*>(instance), attachToken,
-                        std::bind(std::mem_fn(memberFunction), instance));
-
-    handlers.emplace_back(handler_ident);
+    AddHandler(handler{static_cast<void*>(instance), attachToken,
+                       std::bind(std::mem_fn(memberFunction), instance)});
     return attachToken;
   }
 
@@ -34,52 +37,149 @@ class Notifier {
 
     const auto attachToken = GetAttachToken();
 
-    auto handler_ident = std::make_tuple(static_cast<void*>(nullptr),
-                                         attachToken, std::bind(function));
-
-    handlers.emplace_back(handler_ident);
+    AddHandler(handler{nullptr, attachToken, std::bind(function)});
     return attachToken;
   }
 
   void Detach(std::size_t attachToken) {
-    auto attach_tokens_match = [attachToken](handler i) {
-      return attachToken == std::get<1>(i);
-    };
-
-    handlers.erase(
-        std::remove_if(handlers.begin(), handlers.end(), attach_tokens_match),
-        handlers.end());
+    RemoveHandlers(
+        [attachToken](const handler& i) { return attachToken == i.token; });
   }
 
   void DetachAll(void* instance) {
     assert(instance != nullptr);
 
-    auto handler_instance_matches = [instance](handler i) {
-      return instance == std::get<0>(i);
-    };
+    RemoveHandlers(
+        [instance](const handler& i) { return instance == i.instance; });
+  }
 
-    handlers.erase(std::remove_if(handlers.begin(), handlers.end(),
-                                  handler_instance_matches),
-                   handlers.end());
+  bool HasObservers() const {
+    return !handlers.empty() || !pendingHandlers.empty();
   }
 
+  // Calls the handlers in place, without copying them. A handler attached
+  // while notifying is first called by the next notification, one detached
+  // is skipped if it hasn't been called yet. A handler may destroy the
+  // notifier, the remaining handlers are then skipped. A handler that throws
+  // ends the notification, the exception propagates to the caller.
   void NotifyObservers() const {
-    auto tempHandlers = handlers;
-    for (auto& handler : tempHandlers) {
-      if (std::get<2>(handler) != nullptr) {
-        std::get<2>(handler)();
+    NotifyScope scope(*this);
+
+    const auto count = handlers.size();
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto& current = handlers[i];
+      if (current.detached || current.function == nullptr) {
+        continue;
+      }
+
+      current.function();
+      if (scope.destroyed) {
+        return;
       }
     }
   }
 
  private:
+  // Restores the notification state when NotifyObservers returns or a
+  // handler throws, unless a handler destroyed the notifier.
+  class NotifyScope {
+   public:
+    explicit NotifyScope(const Notifier& notifier)
+        : m_notifier{notifier}, m_pOuterDestroyed{notifier.pDestroyed} {
+      m_notifier.pDestroyed = &destroyed;
+      ++m_notifier.notifyDepth;
+    }
+
+    ~NotifyScope() {
+      if (destroyed) {
+        if (m_pOuterDestroyed != nullptr) {
+          *m_pOuterDestroyed = true;
+        }
+        return;
+      }
+
+      m_notifier.pDestroyed = m_pOuterDestroyed;
+      if (--m_notifier.notifyDepth == 0) {
+        m_notifier.ApplyPendingChanges();
+      }
+    }
+
+    NotifyScope(const NotifyScope&) = delete;
+    NotifyScope& operator=(const NotifyScope&) = delete;
+
+    bool destroyed{false};
+
+   private:
+    const Notifier& m_notifier;
+    bool* const m_pOuterDestroyed;
+  };
+
   std::size_t GetAttachToken() { return nextUniqueToken++; }
 
+  // A detached handler stays in place until the outermost notification
+  // finishes.
+  struct handler {
+    void* instance;
+    std::size_t token;
+    std::function<void()> function;
+    bool detached{false};
+  };
+
+  void AddHandler(handler added) {
+    if (notifyDepth > 0) {
+      pendingHandlers.push_back(std::move(added));
+    } else {
+      handlers.push_back(std::move(added));
+    }
+  }
+
+  template <class Predicate>
+  void RemoveHandlers(Predicate matches) {
+    pendingHandlers.erase(std::remove_if(pendingHandlers.begin(),
+                                         pendingHandlers.end(), matches),
+                          pendingHandlers.end());
+
+    if (notifyDepth > 0) {
+      // The handler list can't change shape mid-notification.
+      for (auto& i : handlers) {
+        if (matches(i)) {
+          i.detached = true;
+          hasDetachedHandlers = true;
+        }
+      }
+      return;
+    }
+
+    handlers.erase(std::remove_if(handlers.begin(), handlers.end(), matches),
+                   handlers.end());
+  }
+
+  void ApplyPendingChanges() const {
+    if (hasDetachedHandlers) {
+      handlers.erase(
+          std::remove_if(handlers.begin(), handlers.end(),
+                         [](const handler& i) { return i.detached; }),
+          handlers.end());
+      hasDetachedHandlers = false;
+    }
+
+    if (!pendingHandlers.empty()) {
+      for (auto& pending : pendingHandlers) {
+        handlers.push_back(std::move(pending));
+      }
+      pendingHandlers.clear();
+    }
+  }
+
  private:
-  // <pointer to observing class, function identifier, function>
-  using handler = std::tuple<void*, std::size_t, std::function<void()>>;
-  std::vector<handler> handlers;
-  std::atomic<std::size_t> nextUniqueToken;
+  // Mutable so NotifyObservers stays const for Release; only the bookkeeping
+  // for changes made mid-notification touches them there.
+  mutable std::vector<handler> handlers;
+  mutable std::vector<handler> pendingHandlers;
+  mutable unsigned int notifyDepth{0};
+  mutable bool hasDetachedHandlers{false};
+  mutable bool* pDestroyed{nullptr};
+  ThreadingPolicy::Counter<std::size_t> nextUniqueToken{0};
 };
 
 }  // namespace framework
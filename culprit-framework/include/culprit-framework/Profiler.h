@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace culprit {
+namespace framework {
+
+struct ProfileEvent {
+  const char* category{nullptr};
+  const char* name{nullptr};
+  std::int64_t startNs{0};
+  std::int64_t durationNs{0};
+  // Extra value shown with the event, e.g. a command's chain position.
+  std::int64_t arg{-1};
+};
+
+// Collects timed events into a fixed size buffer per thread. Each thread only
+// ever writes its own buffer, so recording takes no locks; a full buffer drops
+// new events rather than blocking.
+//
+// The framework only records when built with CULPRIT_ENABLE_PROFILING, the
+// CULPRIT_PROFILE_* macros compile to nothing otherwise.
+class Profiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static void Record(const char* category, const char* name,
+                     Clock::time_point start, Clock::time_point end,
+                     std::int64_t arg = -1);
+
+  // Writes every thread's events as Chrome trace_event JSON, which both
+  // chrome://tracing and the Perfetto UI open directly.
+  static bool WriteChromeTrace(const std::string& path);
+
+  // Only call when no thread is recording.
+  static void Clear();
+
+  // Applies to buffers of threads that have not recorded yet.
+  static void SetThreadBufferCapacity(std::size_t eventCount);
+
+  static std::size_t GetRecordedCount();
+  static std::size_t GetDroppedCount();
+};
+
+class ProfileScope {
+ public:
+  ProfileScope(const char* category, const char* name, std::int64_t arg = -1)
+      : m_category{category},
+        m_name{name},
+        m_arg{arg},
+        m_start{Profiler::Clock::now()} {}
+
+  ~ProfileScope() {
+    Profiler::Record(m_category, m_name, m_start, Profiler::Clock::now(),
+                     m_arg);
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  const char* m_category;
+  const char* m_name;
+  std::int64_t m_arg;
+  Profiler::Clock::time_point m_start;
+};
+
+}  // namespace framework
+}  // namespace culprit
+
+#define CULPRIT_PROFILE_CONCAT_INNER(a, b) a##b
+#define CULPRIT_PROFILE_CONCAT(a, b) CULPRIT_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(CULPRIT_ENABLE_PROFILING)
+#define CULPRIT_PROFILE_SCOPE(category, name)  \
+  ::culprit::framework::ProfileScope           \
+  CULPRIT_PROFILE_CONCAT(culpritProfileScope, __LINE__)(category, name)
+#define CULPRIT_PROFILE_SCOPE_ARG(category, name, arg)                  \
+  ::culprit::framework::ProfileScope                                    \
+  CULPRIT_PROFILE_CONCAT(culpritProfileScope, __LINE__)(category, name, \
+                                                        arg)
+#else
+#define CULPRIT_PROFILE_SCOPE(category, name) static_cast<void>(0)
+#define CULPRIT_PROFILE_SCOPE_ARG(category, name, arg) static_cast<void>(0)
+#endif
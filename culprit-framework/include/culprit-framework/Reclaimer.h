@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ThreadingPolicy.h"
+
+namespace culprit {
+namespace framework {
+
+// Takes over references to objects the framework has finished with, so the
+// last release, and with it the destructor, happens away from the update
+// that removed them. Anything else still referencing an object keeps it
+// alive as usual.
+//
+// Budgeted mode releases in the root context's PostUpdate, up to a time
+// budget per frame. Background mode releases on its own thread, only use it
+// when the retired objects are safe to destroy there. Single threaded builds
+// only support Budgeted mode.
+//
+// The root context owns the tree's reclaimer and releases anything still
+// queued when it is destroyed. Override ContextBase::CreateReclaimer on the
+// root to choose the mode.
+class Reclaimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Mode { Budgeted, Background };
+
+  explicit Reclaimer(
+      Mode mode = Mode::Budgeted,
+      std::chrono::microseconds frameBudget = std::chrono::microseconds{500});
+  // Releases whatever is still queued on the destroying thread.
+  ~Reclaimer();
+
+  Reclaimer(const Reclaimer&) = delete;
+  Reclaimer& operator=(const Reclaimer&) = delete;
+
+  // Safe to call from any thread.
+  void Retire(std::shared_ptr<void> object);
+
+  // Budgeted mode only. Releases at least one object, then carries on until
+  // the budget is used.
+  void RunFrame();
+
+  // Releases everything queued now, on the calling thread.
+  void Drain();
+
+  Mode GetMode() const { return m_mode; }
+  std::size_t GetPendingCount() const;
+  std::uint64_t GetReleasedCount() const {
+    return m_releasedCount.load(std::memory_order_relaxed);
+  }
+
+ private:
+  bool ReleaseOne();
+  void RunBackground();
+
+  const Mode m_mode;
+  const std::chrono::microseconds m_frameBudget;
+
+  mutable ThreadingPolicy::Mutex m_mutex;
+  std::deque<std::shared_ptr<void>> m_retired;
+#if !defined(CULPRIT_SINGLE_THREADED)
+  std::condition_variable m_wake;
+  bool m_stopping{false};
+  std::thread m_thread;
+#endif
+
+  ThreadingPolicy::Counter<std::uint64_t> m_releasedCount{0};
+};
+
+}  // namespace framework
+}  // namespace culprit
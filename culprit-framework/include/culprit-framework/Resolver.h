@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace culprit {
+namespace framework {
+class ContextBase;
+
+// One binding in a resolver map. The creator doesn't capture a context, so
+// contexts built from the same bindings share it; owner is the context whose
+// bindings its dependencies resolve against.
+struct Resolver {
+  using Creator = std::function<std::shared_ptr<void>(ContextBase&)>;
+
+  std::shared_ptr<const Creator> creator;
+  ContextBase* owner{nullptr};
+
+  std::shared_ptr<void> operator()() const { return (*creator)(*owner); }
+};
+
+using ResolverMap = std::unordered_map<std::size_t, Resolver>;
+
+// A context's bindings and singletons as they were when it was built. Never
+// changed once published, so any thread can read it without locking. Entries
+// point into the context's maps, whose entries are only erased while it is
+// being built or recycled.
+struct ResolutionTable {
+  struct Entry {
+    std::size_t key;
+    const Resolver* resolver;
+    const std::shared_ptr<void>* instance;
+    bool singleton;
+  };
+
+  // Sorted by key.
+  std::vector<Entry> entries;
+
+  const Entry* Find(std::size_t key) const {
+    const auto found = std::lower_bound(
+        entries.begin(), entries.end(), key,
+        [](const Entry& entry, std::size_t value) { return entry.key < value; });
+    return found != entries.end() && found->key == key ? &*found : nullptr;
+  }
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ThreadingPolicy.h"
+#include "UniqueKeyGenerator.h"
+
+namespace culprit {
+namespace framework {
+
+template <typename T, const size_t N = 0>
+struct store_key {};
+
+// The objects stored with StoreShared, one store for a whole context tree.
+// The root owns it and every descendant refers to the same one.
+//
+// Writes are staged and published together as a new immutable snapshot when
+// the root commits at the end of the frame. Find and Get read the last
+// published snapshot without locking, so any thread can use them while the
+// main thread carries on writing. Snapshots are pooled rather than freed, and
+// a commit only reuses one that no reader has pinned.
+class SharedStore {
+ public:
+  SharedStore();
+  ~SharedStore();
+
+  SharedStore(const SharedStore&) = delete;
+  SharedStore& operator=(const SharedStore&) = delete;
+
+  // Any thread. Sees the last published snapshot.
+  std::shared_ptr<void> Find(std::size_t key) const;
+
+  template <class Key, const std::size_t N = 0>
+  std::shared_ptr<Key> Get() const {
+    return std::static_pointer_cast<Key>(
+        Find(UniqueKeyGenerator::Get<store_key<Key, N>>()));
+  }
+
+  // Counts commits that published a change.
+  std::uint64_t GetVersion() const;
+
+  // Writer side, serialised with each other. FindStaged also sees writes and
+  // removals staged since the last commit, which readers only see once it is
+  // committed.
+  void Put(std::size_t key, std::shared_ptr<void> value);
+  void Remove(std::size_t key);
+  std::shared_ptr<void> FindStaged(std::size_t key) const;
+  bool HasStagedWrites() const;
+
+  void Commit();
+
+ private:
+  struct Entry {
+    std::size_t key;
+    std::shared_ptr<void> value;
+  };
+
+  // Sorted by key.
+  struct Snapshot {
+    std::vector<Entry> entries;
+    std::uint64_t version{0};
+    mutable ThreadingPolicy::Counter<unsigned int> readers{0};
+
+    const Entry* Find(std::size_t key) const;
+  };
+
+  // The published snapshot, which the commit won't reuse until Unpin.
+  const Snapshot* Pin() const;
+  static void Unpin(const Snapshot* snapshot);
+
+  ThreadingPolicy::Atomic<const Snapshot*> m_pPublished{nullptr};
+  Snapshot* m_current{nullptr};
+  std::vector<std::unique_ptr<Snapshot>> m_snapshots;
+
+  mutable ThreadingPolicy::Mutex m_writeMutex;
+  std::vector<Entry> m_staged;
+  std::vector<std::size_t> m_removed;
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -1,21 +1,66 @@
 #pragma once
 
+#include <functional>
 #include <tuple>
 #include <typeinfo>
 
+#include "AllocationTracker.h"
+#include "Metrics.h"
 #include "Notifier.hpp"
+#include "Profiler.h"
 
 namespace culprit {
 namespace framework {
 
-class SignalBase : public Notifier {};
+class SignalBase;
+
+// Installed per thread to hold back dispatches that must not run there yet.
+// A deferred dispatch notifies its observers when the gate's owner runs it.
+class DispatchGate {
+ public:
+  virtual ~DispatchGate() = default;
+
+  virtual bool ShouldDefer(const SignalBase& signal) const = 0;
+  virtual void Defer(std::function<void()> dispatch) = 0;
+
+  static DispatchGate*& Current() {
+    thread_local DispatchGate* gate = nullptr;
+    return gate;
+  }
+};
+
+class SignalBase : public Notifier {
+ public:
+  std::uint64_t GetDispatchCount() const {
+    return static_cast<std::uint64_t>(m_dispatchCount.Read());
+  }
+
+  // The context that created the signal.
+  void SetOwner(const void* owner) { m_owner = owner; }
+  const void* GetOwner() const { return m_owner; }
+
+ protected:
+  MetricCounter m_dispatchCount;
+
+ private:
+  const void* m_owner{nullptr};
+};
 
 template <class... Ts>
 class Signal : public SignalBase {
  public:
   void Dispatch(Ts&&... args) {
-    _params = std::make_tuple(std::forward<Ts>(args)...);
-    NotifyObservers();
+    auto params = std::make_tuple(std::forward<Ts>(args)...);
+
+    DispatchGate* gate = DispatchGate::Current();
+    if (gate != nullptr && gate->ShouldDefer(*this)) {
+      gate->Defer([this, params = std::move(params)]() mutable {
+        Notify(std::move(params));
+      });
+      return;
+    }
+
+    Notify(std::move(params));
   }
 
   template <size_t I = 0,
@@ -25,6 +70,14 @@ class Signal : public SignalBase {
   }
 
  private:
+  void Notify(std::tuple<Ts...> params) {
+    CULPRIT_PROFILE_SCOPE("Dispatch", typeid(*this).name());
+    CULPRIT_ALLOCATION_SCOPE(Dispatch);
+    m_dispatchCount.Add();
+    _params = std::move(params);
+    NotifyObservers();
+  }
+
   std::tuple<Ts...> _params;
 };
 
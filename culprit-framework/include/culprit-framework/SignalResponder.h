@@ -5,15 +5,15 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Metrics.h"
+#include "Resolver.h"
+
 namespace culprit {
 namespace framework {
 class CommandBase;
 
 class SignalResponder {
-  using CreatorFunction = std::function<std::shared_ptr<void>()>;
-  using ResolverMap = std::unordered_map<std::size_t, std::shared_ptr<CreatorFunction>>;
-  using CommandResolverMap =
-      std::unordered_map<std::size_t, std::shared_ptr<CreatorFunction>>;
+  using CommandResolverMap = ResolverMap;
 
  public:
   SignalResponder(const ResolverMap& resolverMap,
@@ -25,6 +25,11 @@ class SignalResponder {
   void Respond();
   void OnCommandReleased();
   void AddCommand(std::size_t commandID);
+  const std::vector<std::size_t>& GetCommands() const { return m_commands; }
+
+  std::uint64_t GetChainsStarted() const;
+  std::uint64_t GetChainsCompleted() const;
+  std::uint64_t GetCommandsExecuted() const;
 
  private:
   inline void ExecuteCommand();
@@ -39,6 +44,10 @@ class SignalResponder {
 
   std::size_t attachToken{0};
   std::size_t m_signalID{0};
+
+  MetricCounter m_chainsStarted;
+  MetricCounter m_chainsCompleted;
+  MetricCounter m_commandsExecuted;
 };
 
 }  // namespace framework
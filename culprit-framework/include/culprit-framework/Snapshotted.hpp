@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "ThreadingPolicy.h"
+
+namespace culprit {
+namespace framework {
+
+// Frame-consistent copies of a model for reading on other threads, e.g. a
+// renderer. The context that bound it with ToSnapshotted copies the model
+// into a free buffer at the end of each PostUpdate and publishes it; readers
+// pin the latest published buffer without locking.
+//
+// There are three buffers, so the writer always has one free while one
+// reader holds a view. When more readers pin every other buffer the copy is
+// skipped, and readers keep seeing the last completed frame.
+template <class Model>
+class Snapshotted {
+  static constexpr std::size_t kBuffers = 3;
+  static constexpr std::size_t kNone = kBuffers;
+  using ReaderCount = ThreadingPolicy::Counter<unsigned int>;
+
+ public:
+  // A pinned buffer, not overwritten while the view exists. Keep it for as
+  // long as a frame's reading takes, not longer, and don't outlive the
+  // Snapshotted it came from.
+  class View {
+   public:
+    View() = default;
+    View(const View&) = delete;
+    View& operator=(const View&) = delete;
+    View(View&& other) noexcept { *this = std::move(other); }
+    View& operator=(View&& other) noexcept {
+      if (this != &other) {
+        Release();
+        m_pModel = other.m_pModel;
+        m_pReaders = other.m_pReaders;
+        m_version = other.m_version;
+        other.m_pModel = nullptr;
+        other.m_pReaders = nullptr;
+      }
+      return *this;
+    }
+    ~View() { Release(); }
+
+    // False until the first publish.
+    explicit operator bool() const { return m_pModel != nullptr; }
+    const Model& operator*() const { return *m_pModel; }
+    const Model* operator->() const { return m_pModel; }
+    const Model* get() const { return m_pModel; }
+
+    // Counts publishes, so a reader can tell a new frame from a repeat.
+    std::uint64_t GetVersion() const { return m_version; }
+
+   private:
+    friend class Snapshotted;
+
+    View(const Model* pModel, ReaderCount* pReaders, std::uint64_t version)
+        : m_pModel{pModel}, m_pReaders{pReaders}, m_version{version} {}
+
+    void Release() {
+      if (m_pReaders) {
+        m_pReaders->fetch_sub(1);
+      }
+    }
+
+    const Model* m_pModel{nullptr};
+    ReaderCount* m_pReaders{nullptr};
+    std::uint64_t m_version{0};
+  };
+
+  // Any thread.
+  View Read() const {
+    for (;;) {
+      const auto latest = m_latest.load();
+      if (latest == kNone) {
+        return View{};
+      }
+
+      // Pinned only if it is still the latest once counted, otherwise the
+      // writer may already be copying into it.
+      m_readers[latest].fetch_add(1);
+      if (m_latest.load() == latest) {
+        return View{&*m_buffers[latest], &m_readers[latest],
+                    m_versions[latest]};
+      }
+      m_readers[latest].fetch_sub(1);
+    }
+  }
+
+  // The publishing context's thread only. Returns false if every other
+  // buffer was pinned and the frame was skipped.
+  bool Publish(const Model& model) {
+    const auto latest = m_latest.load();
+    for (std::size_t i = 0; i < kBuffers; ++i) {
+      if (i == latest || m_readers[i].load() != 0) {
+        continue;
+      }
+
+      if (m_buffers[i]) {
+        *m_buffers[i] = model;
+      } else {
+        m_buffers[i].emplace(model);
+      }
+      m_versions[i] = ++m_published;
+      m_latest.store(i);
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  std::array<std::optional<Model>, kBuffers> m_buffers;
+  std::array<std::uint64_t, kBuffers> m_versions{};
+  mutable std::array<ReaderCount, kBuffers> m_readers{};
+  ThreadingPolicy::Atomic<std::size_t> m_latest{kNone};
+  std::uint64_t m_published{0};
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
+#include "ContextBase.h"
+#include "Creator.hpp"
+
+namespace culprit {
+namespace framework {
+
+// Compile-time equivalents of Bind<Key>().To<Value, Dependencies...>() and
+// Bind<Key>().ToSingleton<Value, Dependencies...>(), listed as
+// StaticContext template arguments, e.g.
+//   bind_singleton<Key, creator<Value, Dependency1, Dependency2>>
+template <class Key, class Creator>
+struct bind_to;
+
+template <class Key, class Creator>
+struct bind_singleton;
+
+template <class Key, class Value, class... Dependencies>
+struct bind_to<Key, creator<Value, Dependencies...>> {
+  static_assert(std::is_base_of<Key, Value>() || std::is_base_of<Value, Key>(),
+                "Value is not derived type of Key");
+
+  using key = Key;
+  using value = Value;
+  static constexpr bool singleton = false;
+
+  template <class Context>
+  static std::shared_ptr<Value> Create(Context& context) {
+    return std::make_shared<Value>(
+        context.template Get<Dependencies>()...);
+  }
+};
+
+template <class Key, class Value, class... Dependencies>
+struct bind_singleton<Key, creator<Value, Dependencies...>>
+    : bind_to<Key, creator<Value, Dependencies...>> {
+  static constexpr bool singleton = true;
+};
+
+template <class Key, class... Bindings>
+constexpr std::size_t static_binding_index() {
+  constexpr bool matches[] = {
+      std::is_same<Key, typename Bindings::key>::value..., false};
+  for (std::size_t i = 0; i < sizeof...(Bindings); ++i) {
+    if (matches[i]) {
+      return i;
+    }
+  }
+  return sizeof...(Bindings);
+}
+
+template <class Key, class... Bindings>
+constexpr std::size_t static_binding_count() {
+  return (std::size_t{std::is_same<Key, typename Bindings::key>::value} + ... +
+          0);
+}
+
+// A context whose bindings are fixed at compile time. Get<Key>() on a key in
+// Bindings is a direct make_shared, or for a singleton a member read after
+// the first call, with no lookups. Keys it doesn't list, including its own
+// dependencies, fall back to Resolve and so to the parent's bindings.
+//
+// It is a ContextBase, so it can be the parent or child of any other
+// context. The listed keys are also bound at runtime to forward to Get, so
+// Resolve, commands and child contexts see the same instances, and shadow the
+// parent's bindings of the same keys. Runtime-only
+// bindings, such as signals and their commands, go in SetRuntimeBindings.
+//
+// Singletons are created on first use, under the context's mutation lock as
+// workers may resolve them too, and dropped when a pooled instance is
+// recycled; call StaticContext::OnRecycle from an override.
+template <class... Bindings>
+class StaticContext : public ContextBase {
+  static_assert(
+      ((static_binding_count<typename Bindings::key, Bindings...>() == 1) &&
+       ...),
+      "Attempting to bind already bound key.");
+
+ public:
+  template <class Key>
+  std::shared_ptr<Key> Get();
+
+  template <class Key>
+  static constexpr bool IsStaticallyBound() {
+    return static_binding_index<Key, Bindings...>() < sizeof...(Bindings);
+  }
+
+ protected:
+  virtual void SetRuntimeBindings() {}
+
+  void OnRecycle() override {
+    m_singletons = Singletons{};
+    for (auto& created : m_created) {
+      created.store(false, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  using Singletons = std::tuple<std::shared_ptr<typename Bindings::value>...>;
+
+  void SetBindings() final {
+    (BindCreator<typename Bindings::key>(
+         &StaticContext::ForwardToGet<typename Bindings::key>),
+     ...);
+    SetRuntimeBindings();
+  }
+
+  template <class Key>
+  static std::shared_ptr<Key> ForwardToGet(ContextBase& owner) {
+    return static_cast<StaticContext&>(owner).template Get<Key>();
+  }
+
+  Singletons m_singletons;
+  // Set once the matching singleton exists, so Get only locks to create it.
+  std::array<ThreadingPolicy::Atomic<bool>, sizeof...(Bindings)> m_created{};
+};
+
+template <class... Bindings>
+template <class Key>
+std::shared_ptr<Key> StaticContext<Bindings...>::Get() {
+  constexpr auto index =
+      static_binding_index<remove_const_t<Key>, Bindings...>();
+
+  if constexpr (index == sizeof...(Bindings)) {
+    return Resolve<Key>();
+  } else {
+    using Binding = std::tuple_element_t<index, std::tuple<Bindings...>>;
+
+    if constexpr (Binding::singleton) {
+      auto& instance = std::get<index>(m_singletons);
+      if (!m_created[index].load(std::memory_order_acquire)) {
+        std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(
+            GetMutationMutex());
+        if (!instance) {
+          instance = Binding::Create(*this);
+          m_created[index].store(true, std::memory_order_release);
+        }
+      }
+      return instance;
+    } else {
+      return Binding::Create(*this);
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace culprit
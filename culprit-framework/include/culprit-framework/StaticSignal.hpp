@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cassert>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+
+#include "Creator.hpp"
+#include "Signal.hpp"
+
+namespace culprit {
+namespace framework {
+
+// The commands a StaticSignal runs, in order, each given as
+// creator<Command, Dependencies...>.
+template <class... Creators>
+struct command_chain;
+
+template <class Creator>
+struct chain_link;
+
+template <class Command, class... Dependencies>
+struct chain_link<creator<Command, Dependencies...>> {
+  using command = Command;
+
+  template <class Context>
+  static Command Create(Context& context) {
+    return Command(context.template Resolve<Dependencies>()...);
+  }
+};
+
+template <class Chain, class... Ts>
+class StaticSignal;
+
+// A signal whose command chain is fixed by its type. Dispatch calls each
+// command's non-virtual Execute(const Ts&...) directly with the payload, so
+// the chain inlines like a plain function call.
+//
+// Bind it with BindSignal; the commands are built once, when the signal is,
+// with their dependencies resolved from the binding context. They run to
+// completion in order within Dispatch, there is no Release. Observers
+// attached to the signal are still notified after the chain.
+template <class... Creators, class... Ts>
+class StaticSignal<command_chain<Creators...>, Ts...> : public SignalBase {
+ public:
+  using Commands = std::tuple<typename chain_link<Creators>::command...>;
+
+  void Dispatch(const Ts&... args) {
+    assert(m_commands.has_value());
+
+    DispatchGate* gate = DispatchGate::Current();
+    if (gate != nullptr && gate->ShouldDefer(*this)) {
+      gate->Defer([this, params = std::make_tuple(args...)]() {
+        std::apply([this](const Ts&... deferred) { Notify(deferred...); },
+                   params);
+      });
+      return;
+    }
+
+    Notify(args...);
+  }
+
+  template <class Context>
+  void Wire(Context& context) {
+    m_commands.emplace(chain_link<Creators>::Create(context)...);
+  }
+
+  template <class Command>
+  Command& GetCommand() {
+    return std::get<Command>(*m_commands);
+  }
+
+ private:
+  void Notify(const Ts&... args) {
+    CULPRIT_PROFILE_SCOPE("Dispatch", typeid(*this).name());
+    CULPRIT_ALLOCATION_SCOPE(Dispatch);
+    m_dispatchCount.Add();
+
+    std::apply([&](auto&... commands) { (commands.Execute(args...), ...); },
+               *m_commands);
+
+    if (HasObservers()) {
+      NotifyObservers();
+    }
+  }
+
+  std::optional<Commands> m_commands;
+};
+
+template <class... Creators, class... Ts>
+std::true_type IsStaticSignal(
+    const StaticSignal<command_chain<Creators...>, Ts...>*);
+std::false_type IsStaticSignal(const void*);
+
+template <class Signal>
+using is_statically_wired =
+    decltype(IsStaticSignal(static_cast<const Signal*>(nullptr)));
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+namespace culprit {
+namespace framework {
+
+#if defined(CULPRIT_SINGLE_THREADED)
+// Stands in for std::mutex when only one thread ever uses the framework.
+class NullMutex {
+ public:
+  void lock() {}
+  bool try_lock() { return true; }
+  void unlock() {}
+};
+
+// A plain value with the subset of std::atomic's interface the framework
+// uses.
+template <class T>
+class PlainAtomic {
+ public:
+  constexpr PlainAtomic(T value = T{}) : m_value{value} {}
+
+  T fetch_add(T amount, std::memory_order = std::memory_order_seq_cst) {
+    const T previous = m_value;
+    m_value += amount;
+    return previous;
+  }
+  T fetch_sub(T amount, std::memory_order = std::memory_order_seq_cst) {
+    const T previous = m_value;
+    m_value -= amount;
+    return previous;
+  }
+  T load(std::memory_order = std::memory_order_seq_cst) const {
+    return m_value;
+  }
+  void store(T value, std::memory_order = std::memory_order_seq_cst) {
+    m_value = value;
+  }
+  T operator++(int) { return fetch_add(1); }
+
+ private:
+  T m_value;
+};
+#endif
+
+// Synchronisation for the framework's internal counters and per-frame locks.
+// Built with CULPRIT_SINGLE_THREADED they become plain integers and no-op
+// locks, and the features that run framework code on other threads (worker
+// pools, background reclamation) are unavailable. The default policy is
+// safe to use across threads.
+struct ThreadingPolicy {
+#if defined(CULPRIT_SINGLE_THREADED)
+  static constexpr bool IsSingleThreaded = true;
+  using Mutex = NullMutex;
+  using RecursiveMutex = NullMutex;
+  template <class T>
+  using Atomic = PlainAtomic<T>;
+  template <class T>
+  using Counter = PlainAtomic<T>;
+#else
+  static constexpr bool IsSingleThreaded = false;
+  using Mutex = std::mutex;
+  using RecursiveMutex = std::recursive_mutex;
+  template <class T>
+  using Atomic = std::atomic<T>;
+  template <class T>
+  using Counter = std::atomic<T>;
+#endif
+};
+
+}  // namespace framework
+}  // namespace culprit
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+namespace culprit {
+namespace framework {
+
+// How often an updatable's Update is called. Reduced-rate updatables are
+// handed the delta time accumulated since their last Update.
+class UpdateRate {
+ public:
+  static UpdateRate EveryFrame() { return UpdateRate{1, 0.0}; }
+
+  static UpdateRate EveryNthFrame(unsigned int frameDivisor) {
+    assert(frameDivisor > 0);
+    return UpdateRate{frameDivisor, 0.0};
+  }
+
+  static UpdateRate AtFrequency(double ticksPerSecond) {
+    assert(ticksPerSecond > 0.0);
+    return UpdateRate{1, 1.0 / ticksPerSecond};
+  }
+
+  unsigned int GetFrameDivisor() const { return m_frameDivisor; }
+  double GetInterval() const { return m_interval; }
+  bool IsEveryFrame() const { return m_frameDivisor <= 1 && m_interval <= 0.0; }
+
+ private:
+  UpdateRate(unsigned int frameDivisor, double interval)
+      : m_frameDivisor{frameDivisor}, m_interval{interval} {}
+
+  unsigned int m_frameDivisor{1};
+  double m_interval{0.0};
+};
+
+// Per-updatable scheduling state. The slot staggers updatables sharing a rate
+// so they don't all land on the same frame.
+class UpdateSchedule {
+ public:
+  UpdateSchedule(UpdateRate rate, unsigned int slot) : m_rate{rate} {
+    if (m_rate.GetFrameDivisor() > 1) {
+      m_framePhase = slot % m_rate.GetFrameDivisor();
+    } else if (m_rate.GetInterval() > 0.0) {
+      // Golden ratio offsets spread any number of slots evenly over the
+      // interval without knowing the frame rate up front.
+      const double fraction = slot * 0.6180339887498949;
+      m_untilDue = (1.0 - (fraction - static_cast<std::uint64_t>(fraction))) *
+                   m_rate.GetInterval();
+    }
+  }
+
+  bool IsActive() const { return m_active; }
+  void SetActive(bool active) { m_active = active; }
+
+  // Returns true if the updatable should run this frame, writing the time
+  // elapsed since it last ran into elapsedTime.
+  bool Advance(double deltaTime, std::uint64_t frameIndex,
+               double& elapsedTime) {
+    if (m_rate.IsEveryFrame()) {
+      elapsedTime = deltaTime;
+      return true;
+    }
+
+    m_accumulatedTime += deltaTime;
+
+    if (m_rate.GetFrameDivisor() > 1) {
+      if ((frameIndex + m_framePhase + 1) % m_rate.GetFrameDivisor() != 0) {
+        return false;
+      }
+    } else {
+      m_untilDue -= deltaTime;
+      if (m_untilDue > 0.0) {
+        return false;
+      }
+
+      m_untilDue += m_rate.GetInterval();
+      if (m_untilDue <= 0.0) {
+        // Fell more than an interval behind, don't try to catch up.
+        m_untilDue = m_rate.GetInterval();
+      }
+    }
+
+    elapsedTime = m_accumulatedTime;
+    m_accumulatedTime = 0.0;
+    return true;
+  }
+
+ private:
+  UpdateRate m_rate;
+  bool m_active{true};
+  unsigned int m_framePhase{0};
+  double m_untilDue{0.0};
+  double m_accumulatedTime{0.0};
+};
+
+}  // namespace framework
+}  // namespace culprit
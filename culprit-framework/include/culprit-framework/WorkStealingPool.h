@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace culprit {
+namespace framework {
+
+// Fixed set of worker threads, each with its own task queue. A worker takes
+// from the back of its own queue and steals from the front of the others
+// when it runs dry.
+class WorkStealingPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(
+      std::size_t threadCount = std::thread::hardware_concurrency());
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  std::size_t GetThreadCount() const { return m_threads.size(); }
+
+  void Submit(Task task);
+
+  // Runs every task and returns once they have all finished. The calling
+  // thread runs queued tasks until there are none left, so this is safe to
+  // call from inside a task, then sleeps until the rest finish. The first
+  // exception thrown by a task is rethrown here.
+  void Run(std::vector<Task>& tasks);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void WorkerLoop(std::size_t index);
+  bool TryRunOne(std::size_t preferredQueue);
+  std::size_t GetCallerQueue() const;
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_threads;
+  std::atomic<std::size_t> m_nextQueue{0};
+  std::atomic<std::size_t> m_queuedTasks{0};
+
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  bool m_stopping{false};
+};
+
+}  // namespace framework
+}  // namespace culprit
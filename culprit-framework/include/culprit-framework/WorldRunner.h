@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ContextBase.h"
+
+namespace culprit {
+namespace framework {
+
+struct ShardUtilisation {
+  std::size_t worlds{0};
+  std::uint64_t ticks{0};
+  std::chrono::microseconds busy{0};
+  // Fraction of the sample window the shard spent ticking worlds.
+  double utilisation{0.0};
+};
+
+// Runs many independent root contexts ("worlds") on a fixed set of shard
+// threads, one thread per shard, optionally pinned to a core. Each world
+// ticks with a fixed step at its own rate; a world that falls behind skips
+// the ticks it missed rather than running them back to back.
+//
+// A world is only touched by its shard's thread while the runner is started,
+// so hand it over fully built and keep other threads away from it until it
+// is removed or the runner is stopped. A shard only holds its lock between
+// ticks, so the runner's other calls wait at most for one world's tick.
+class WorldRunner {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using WorldHandle = std::size_t;
+  using ErrorHandler = std::function<void(WorldHandle, std::exception_ptr)>;
+
+  explicit WorldRunner(
+      std::size_t shardCount = std::thread::hardware_concurrency(),
+      bool pinShards = true);
+  ~WorldRunner();
+
+  WorldRunner(const WorldRunner&) = delete;
+  WorldRunner& operator=(const WorldRunner&) = delete;
+
+  void Start();
+  // Waits for each shard's tick in progress. Not to be called from a world's
+  // Tick or the error handler.
+  void Stop();
+
+  std::size_t GetShardCount() const { return m_shards.size(); }
+
+  // Called on the shard's thread when a world's Tick throws, after the tick
+  // has finished and without the runner's locks held. The world keeps
+  // ticking. By default the error is written to std::cerr.
+  //
+  // The handler may call any of the runner's world calls, including
+  // RemoveWorld or MigrateWorld on the failing world, but not Start, Stop or
+  // SetErrorHandler. As the report follows the tick, it can arrive just after
+  // RemoveWorld returns for that world.
+  void SetErrorHandler(ErrorHandler handler);
+
+  // Creates, initialises and enters the world on the calling thread, then
+  // gives it to the shard with the fewest worlds.
+  template <class Context>
+  WorldHandle AddWorld(double tickRate);
+
+  // The world must already be initialised and entered.
+  WorldHandle AddWorld(std::shared_ptr<ContextBase> world, double tickRate);
+
+  // Exits the world once its shard has finished any tick in progress, so a
+  // world can't remove itself from its own Tick.
+  bool RemoveWorld(WorldHandle handle);
+
+  void SetTickRate(WorldHandle handle, double tickRate);
+  std::uint64_t GetTickCount(WorldHandle handle) const;
+
+  std::size_t GetShardOf(WorldHandle handle) const;
+  void MigrateWorld(WorldHandle handle, std::size_t shard);
+
+  // Usage of each shard since the previous sample or Rebalance.
+  std::vector<ShardUtilisation> SampleUtilisation();
+
+  // Moves worlds from the busiest shards to the least busy, using the time
+  // each world spent ticking since the previous sample. Starts a new sample
+  // window.
+  void Rebalance();
+
+ private:
+  struct World {
+    WorldHandle handle;
+    std::shared_ptr<ContextBase> context;
+    Clock::duration interval;
+    double deltaTime;
+    Clock::time_point nextTick;
+    Clock::duration busy{0};
+    std::uint64_t ticks{0};
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<World> worlds;
+    std::thread thread;
+    bool stopping{false};
+
+    // The world whose Tick is running without the lock, zero if none.
+    WorldHandle ticking{0};
+    std::condition_variable tickDone;
+    // Changed whenever worlds are added, removed or moved, so the shard
+    // knows to rescan them after a tick.
+    std::uint64_t worldsVersion{0};
+
+    Clock::time_point windowStart{Clock::now()};
+    Clock::duration busy{0};
+    std::uint64_t ticks{0};
+  };
+
+  void RunShard(std::size_t index);
+  void ReportError(WorldHandle handle, std::exception_ptr error) const;
+  void PinShard(std::size_t index);
+
+  static std::vector<World>::iterator FindWorld(Shard& shard,
+                                                WorldHandle handle);
+  static void WaitForTick(Shard& shard, std::unique_lock<std::mutex>& lock,
+                          WorldHandle handle);
+  Shard& GetShard(WorldHandle handle) const;
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  const bool m_pinShards;
+  bool m_running{false};
+
+  // Guards m_worldShards and m_nextHandle. Always taken before a shard's
+  // mutex.
+  mutable std::mutex m_mutex;
+  std::unordered_map<WorldHandle, std::size_t> m_worldShards;
+  WorldHandle m_nextHandle{1};
+
+  // Set before Start.
+  ErrorHandler m_errorHandler;
+};
+
+template <class Context>
+WorldRunner::WorldHandle WorldRunner::AddWorld(double tickRate) {
+  static_assert(std::is_base_of<ContextBase, Context>(),
+                "World must be ContextBase type");
+
+  auto world = std::make_shared<Context>();
+  world->Initialise();
+  world->Enter();
+  return AddWorld(std::move(world), tickRate);
+}
+
+}  // namespace framework
+}  // namespace culprit
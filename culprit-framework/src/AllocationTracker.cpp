@@ -0,0 +1,207 @@
+#include "culprit-framework/AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+using culprit::framework::AllocationSite;
+using culprit::framework::AllocationTracker;
+
+namespace {
+constexpr auto kSiteCount = static_cast<std::size_t>(AllocationSite::Count);
+
+// Plain statics and thread_locals of trivial types, so counting never
+// allocates or depends on initialisation order.
+std::atomic<std::uint64_t> g_totalCount{0};
+std::array<std::atomic<std::uint64_t>, kSiteCount> g_siteCounts{};
+thread_local std::uint64_t t_threadCount = 0;
+thread_local AllocationSite t_currentSite = AllocationSite::Other;
+
+#if defined(CULPRIT_TRACK_ALLOCATIONS)
+void CountAllocation() {
+  g_totalCount.fetch_add(1, std::memory_order_relaxed);
+  g_siteCounts[static_cast<std::size_t>(t_currentSite)].fetch_add(
+      1, std::memory_order_relaxed);
+  ++t_threadCount;
+}
+
+// Retries through the installed new handler until it gives up, as the
+// standard requires of a replacement operator new.
+template <class TryAllocate>
+void* AllocateOrThrow(TryAllocate tryAllocate) {
+  CountAllocation();
+  for (;;) {
+    if (void* pMemory = tryAllocate()) {
+      return pMemory;
+    }
+    const auto handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+template <class TryAllocate>
+void* AllocateOrNull(TryAllocate tryAllocate) noexcept {
+  try {
+    return AllocateOrThrow(tryAllocate);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* TryAllocate(std::size_t size) {
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+// Over-aligned types, such as the alignas(64) counter shards, come through
+// the align_val_t overloads and need memory freed to match.
+void* TryAllocateAligned(std::size_t size, std::align_val_t alignment) {
+  const auto align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+  return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+  // aligned_alloc wants a size that is a multiple of the alignment.
+  const auto rounded = (size + align - 1) / align * align;
+  return std::aligned_alloc(align, rounded == 0 ? align : rounded);
+#endif
+}
+
+void* Allocate(std::size_t size) {
+  return AllocateOrThrow([size]() { return TryAllocate(size); });
+}
+
+void* AllocateNoThrow(std::size_t size) noexcept {
+  return AllocateOrNull([size]() { return TryAllocate(size); });
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(
+      [size, alignment]() { return TryAllocateAligned(size, alignment); });
+}
+
+void* AllocateAlignedNoThrow(std::size_t size,
+                             std::align_val_t alignment) noexcept {
+  return AllocateOrNull(
+      [size, alignment]() { return TryAllocateAligned(size, alignment); });
+}
+
+void FreeAligned(void* pMemory) {
+#if defined(_WIN32)
+  _aligned_free(pMemory);
+#else
+  std::free(pMemory);
+#endif
+}
+#endif
+}  // namespace
+
+#if defined(CULPRIT_TRACK_ALLOCATIONS)
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size);
+}
+
+void operator delete(void* pMemory) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory) noexcept { std::free(pMemory); }
+void operator delete(void* pMemory, std::size_t) noexcept {
+  std::free(pMemory);
+}
+void operator delete[](void* pMemory, std::size_t) noexcept {
+  std::free(pMemory);
+}
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept {
+  std::free(pMemory);
+}
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept {
+  std::free(pMemory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return AllocateAlignedNoThrow(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return AllocateAlignedNoThrow(size, alignment);
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept {
+  FreeAligned(pMemory);
+}
+void operator delete[](void* pMemory, std::align_val_t) noexcept {
+  FreeAligned(pMemory);
+}
+void operator delete(void* pMemory, std::size_t, std::align_val_t) noexcept {
+  FreeAligned(pMemory);
+}
+void operator delete[](void* pMemory, std::size_t, std::align_val_t) noexcept {
+  FreeAligned(pMemory);
+}
+void operator delete(void* pMemory, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  FreeAligned(pMemory);
+}
+void operator delete[](void* pMemory, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  FreeAligned(pMemory);
+}
+#endif
+
+std::uint64_t AllocationTracker::GetCount() {
+  return g_totalCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AllocationTracker::GetCount(AllocationSite site) {
+  return g_siteCounts[static_cast<std::size_t>(site)].load(
+      std::memory_order_relaxed);
+}
+
+std::uint64_t AllocationTracker::GetThreadCount() { return t_threadCount; }
+
+void AllocationTracker::Reset() {
+  g_totalCount.store(0, std::memory_order_relaxed);
+  for (auto& count : g_siteCounts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+AllocationSite AllocationTracker::GetCurrentSite() { return t_currentSite; }
+
+void AllocationTracker::SetCurrentSite(AllocationSite site) {
+  t_currentSite = site;
+}
+
+const char* AllocationTracker::GetSiteName(AllocationSite site) {
+  switch (site) {
+    case AllocationSite::Resolve:
+      return "Resolve";
+    case AllocationSite::Dispatch:
+      return "Dispatch";
+    case AllocationSite::Command:
+      return "Command";
+    case AllocationSite::Updatable:
+      return "Updatable";
+    case AllocationSite::Store:
+      return "Store";
+    default:
+      return "Other";
+  }
+}
@@ -2,7 +2,43 @@
 
 #include "culprit-framework/Signals.h"
 
+#include <map>
+#include <mutex>
+#include <typeindex>
+
+using culprit::framework::BindingTemplate;
 using culprit::framework::ContextBase;
+using culprit::framework::ContextHandle;
+using culprit::framework::DispatchGate;
+using culprit::framework::MetricsSnapshot;
+using culprit::framework::Resolver;
+using culprit::framework::SignalBase;
+using culprit::framework::SharedStore;
+using culprit::framework::SignalResponder;
+using culprit::framework::ThreadingPolicy;
+using culprit::framework::type_identifier;
+using culprit::framework::WorkStealingPool;
+
+namespace culprit {
+namespace framework {
+// Everything a context's SetBindings added on top of what it inherited.
+struct BindingTemplate {
+  using Creators =
+      std::vector<std::pair<type_identifier,
+                            std::shared_ptr<const Resolver::Creator>>>;
+
+  std::vector<type_identifier> removedKeys;
+  Creators resolvers;
+  Creators commandResolvers;
+  std::vector<std::pair<type_identifier, std::vector<std::size_t>>> responders;
+  // Responders attached to inherited signals, and how many times.
+  std::vector<std::pair<type_identifier, std::size_t>> attachedCommands;
+  std::vector<type_identifier> singletonKeys;
+  std::vector<std::pair<type_identifier, const char*>> signalTypes;
+  std::vector<void (*)(ContextBase&)> snapshotPublishers;
+};
+}  // namespace framework
+}  // namespace culprit
 
 namespace {
 auto swapAndPop = [](auto& vec, size_t index) -> void {
@@ -14,9 +50,75 @@ auto swapAndPop = [](auto& vec, size_t index) -> void {
   }
   vec.pop_back();  // No swap; we simply removed the last element.
 };
+
+using BindingTemplateKey = std::pair<std::type_index, std::size_t>;
+
+// Shared by every context in the process, contexts may be initialised on
+// worker threads.
+struct BindingTemplates {
+  std::mutex mutex;
+  std::map<BindingTemplateKey, std::shared_ptr<const BindingTemplate>>
+      templates;
+};
+
+BindingTemplates& GetBindingTemplates() {
+  static BindingTemplates bindingTemplates;
+  return bindingTemplates;
+}
+
+// The isolated child whose phase is running on this thread, if any.
+thread_local ContextBase* t_isolatedContext = nullptr;
+
+// Installs an isolated child's gate for the current thread. The previous one
+// is restored afterwards, the thread may be helping from inside another
+// isolated phase.
+class ScopedIsolation {
+ public:
+  ScopedIsolation(ContextBase* context, DispatchGate* gate)
+      : m_previousContext{t_isolatedContext},
+        m_previousGate{DispatchGate::Current()} {
+    t_isolatedContext = context;
+    DispatchGate::Current() = gate;
+  }
+
+  ~ScopedIsolation() {
+    t_isolatedContext = m_previousContext;
+    DispatchGate::Current() = m_previousGate;
+  }
+
+ private:
+  ContextBase* m_previousContext;
+  DispatchGate* m_previousGate;
+};
 }  // namespace
 
+ContextBase::~ContextBase() {
+  // Loading children still resolve through this context's bindings.
+  for (auto& pending : m_pendingChildContexts) {
+    pending.loaded.wait();
+  }
+
+  // Releases whatever is still retired here, before the children go.
+  if (m_pOwnedReclaimer) {
+    ForgetReclaimer();
+    for (auto& pending : m_pendingChildContexts) {
+      pending.context->ForgetReclaimer();
+    }
+    m_pOwnedReclaimer.reset();
+  }
+
+  // Children can outlive their parent if something else holds them.
+  for (auto& child : m_childContexts) {
+    if (child.second) {
+      child.second->m_parent = nullptr;
+    }
+  }
+}
+
 void ContextBase::Initialise() {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  m_pResolutionTable.store(nullptr, std::memory_order_release);
+
   // Ensure a parents enter and exit signals are not in the accumulated map
   // before building.
   RemoveBind<EnterContextSignal>();
@@ -26,8 +128,72 @@ void ContextBase::Initialise() {
   RemoveBind<PostUpdateContextSignal>();
   RemoveBind<ContextBase>();
 
+  if (!m_pSharedStore) {
+    m_pSharedStore = std::make_shared<SharedStore>();
+    m_ownsSharedStore = true;
+  }
+
+  if (!m_pReclaimer) {
+    m_pOwnedReclaimer = CreateReclaimer();
+    m_pReclaimer = m_pOwnedReclaimer.get();
+  }
+
+  const bool inheritsFrameScheduler = HasBinding<FrameScheduler>();
+
+  if (UsesBindingTemplate()) {
+    const BindingTemplateKey templateKey{typeid(*this), FingerprintBindings()};
+    auto& bindingTemplates = GetBindingTemplates();
+
+    std::shared_ptr<const BindingTemplate> bindingTemplate;
+    {
+      std::lock_guard<std::mutex> lock(bindingTemplates.mutex);
+      const auto found = bindingTemplates.templates.find(templateKey);
+      if (found != bindingTemplates.templates.end()) {
+        bindingTemplate = found->second;
+      }
+    }
+
+    if (bindingTemplate) {
+      StampBindingTemplate(*bindingTemplate);
+    } else {
+      std::vector<type_identifier> inheritedKeys;
+      inheritedKeys.reserve(m_resolverMap.size());
+      for (const auto& resolver : m_resolverMap) {
+        inheritedKeys.push_back(resolver.first);
+      }
+
+      ApplyBindings();
+
+      std::lock_guard<std::mutex> lock(bindingTemplates.mutex);
+      bindingTemplates.templates.emplace(templateKey,
+                                         RecordBindingTemplate(inheritedKeys));
+    }
+  } else {
+    ApplyBindings();
+  }
+
+  Build();
+
+  m_pEnterSignal = Resolve<EnterContextSignal>();
+  m_pExitSignal = Resolve<ExitContextSignal>();
+  m_pPreUpdateSignal = Resolve<PreUpdateContextSignal>();
+  m_pUpdateSignal = Resolve<UpdateContextSignal>();
+  m_pPostUpdateSignal = Resolve<PostUpdateContextSignal>();
+
+  if (!inheritsFrameScheduler) {
+    m_pFrameScheduler = Resolve<FrameScheduler>();
+  }
+}
+
+void ContextBase::ApplyBindings() {
   SetBindings();
 
+  // The root context provides the deferred work scheduler for the whole tree
+  // unless SetBindings bound one itself.
+  if (!HasBinding<FrameScheduler>()) {
+    Bind<FrameScheduler>().ToSingleton<FrameScheduler>();
+  }
+
   // If this context did not bind enter and exit context, bind them anyway.
   if (!HasBinding<EnterContextSignal>()) {
     BindSignal<EnterContextSignal>();
@@ -48,14 +214,101 @@ void ContextBase::Initialise() {
   if (!HasBinding<PostUpdateContextSignal>()) {
     BindSignal<PostUpdateContextSignal>();
   }
+}
 
-  Build();
+std::shared_ptr<const BindingTemplate> ContextBase::RecordBindingTemplate(
+    const std::vector<type_identifier>& inheritedKeys) const {
+  auto bindingTemplate = std::make_shared<BindingTemplate>();
+
+  for (const auto key : inheritedKeys) {
+    if (m_resolverMap.count(key) == 0) {
+      bindingTemplate->removedKeys.push_back(key);
+    }
+  }
+
+  for (const auto& resolver : m_resolverMap) {
+    if (resolver.second.owner == this) {
+      bindingTemplate->resolvers.emplace_back(resolver.first,
+                                              resolver.second.creator);
+    }
+  }
+
+  for (const auto& resolver : m_commandResolverMap) {
+    bindingTemplate->commandResolvers.emplace_back(resolver.first,
+                                                   resolver.second.creator);
+  }
+
+  for (const auto& responder : m_commandMap) {
+    bindingTemplate->responders.emplace_back(responder.first,
+                                             responder.second->GetCommands());
+  }
+
+  for (const auto& attached : m_attachedCommands) {
+    bindingTemplate->attachedCommands.emplace_back(attached.first,
+                                                   attached.second.size());
+  }
+  for (const auto signalID : m_pendingSignalAttachments) {
+    bindingTemplate->attachedCommands.emplace_back(signalID, 1);
+  }
+
+  bindingTemplate->singletonKeys = asSingletonKeys;
+  bindingTemplate->signalTypes = m_signalTypes;
+  bindingTemplate->snapshotPublishers = m_snapshotPublishers;
+  return bindingTemplate;
 }
 
-void ContextBase::Enter() { Resolve<EnterContextSignal>()->Dispatch(); }
+void ContextBase::StampBindingTemplate(
+    const BindingTemplate& bindingTemplate) {
+  for (const auto key : bindingTemplate.removedKeys) {
+    m_instanceMap.erase(key);
+    m_resolverMap.erase(key);
+  }
+
+  for (const auto& resolver : bindingTemplate.resolvers) {
+    m_instanceMap.erase(resolver.first);
+    m_resolverMap[resolver.first] = Resolver{resolver.second, this};
+  }
+
+  for (const auto& resolver : bindingTemplate.commandResolvers) {
+    m_commandResolverMap[resolver.first] = Resolver{resolver.second, this};
+  }
+
+  for (const auto& responder : bindingTemplate.responders) {
+    auto signalResponder = std::make_shared<SignalResponder>(
+        m_resolverMap, m_commandResolverMap, responder.first);
+    for (const auto commandID : responder.second) {
+      signalResponder->AddCommand(commandID);
+    }
+    m_commandMap.insert(std::make_pair(responder.first, signalResponder));
+  }
+
+  for (const auto& attached : bindingTemplate.attachedCommands) {
+    for (std::size_t i = 0; i < attached.second; ++i) {
+      AttachToInheritedSignal(attached.first);
+    }
+  }
+
+  asSingletonKeys = bindingTemplate.singletonKeys;
+  m_signalTypes = bindingTemplate.signalTypes;
+  m_snapshotPublishers = bindingTemplate.snapshotPublishers;
+}
+
+std::size_t ContextBase::FingerprintBindings() const {
+  // Summed so it doesn't depend on the map's iteration order.
+  std::uint64_t fingerprint = m_resolverMap.size();
+  for (const auto& resolver : m_resolverMap) {
+    std::uint64_t mixed = resolver.first + 0x9e3779b97f4a7c15ull;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ull;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebull;
+    fingerprint += mixed ^ (mixed >> 31);
+  }
+  return static_cast<std::size_t>(fingerprint);
+}
+
+void ContextBase::Enter() { m_pEnterSignal->Dispatch(); }
 
 void ContextBase::Exit() {
-  Resolve<ExitContextSignal>()->Dispatch();
+  m_pExitSignal->Dispatch();
 
   for (const auto& attached : m_attachedCommands) {
     auto signal = std::static_pointer_cast<Notifier>(
@@ -66,43 +319,272 @@ void ContextBase::Exit() {
   }
 
   for (auto& storedKey : m_toRemoveStoredObjects) {
-    m_storedObjects.erase(storedKey);
+    EraseStoredObject(storedKey);
   }
   m_toRemoveStoredObjects.clear();
-
-  for (auto& sharedStoredKey : m_toRemoveSharedStoredObjects) {
-    m_sharedStoredObjects.erase(sharedStoredKey);
-  }
-  m_toRemoveSharedStoredObjects.clear();
+  ApplyKeyedRemovals();
 
   for (auto& updatableKey : m_toRemoveUpdatableObjects) {
     m_updatableObjects.erase(updatableKey);
+    RemoveEventSubscriptions(updatableKey);
   }
   m_toRemoveUpdatableObjects.clear();
 }
 
 void ContextBase::Build() {
   for (const auto& keys : asSingletonKeys) {
-    const auto& creatorFunction = (*m_resolverMap.at(keys));
+    const auto& creatorFunction = m_resolverMap.at(keys);
     (void)creatorFunction();
   }
+
+  PublishResolutionTable();
+
+  // Readers see the models as built until the first PostUpdate.
+  for (const auto publish : m_snapshotPublishers) {
+    publish(*this);
+  }
+}
+
+void ContextBase::PublishResolutionTable() {
+  std::vector<type_identifier> singletonKeys = asSingletonKeys;
+  std::sort(singletonKeys.begin(), singletonKeys.end());
+
+  auto table = std::make_shared<ResolutionTable>();
+  table->entries.reserve(m_resolverMap.size() + m_instanceMap.size());
+  for (const auto& resolver : m_resolverMap) {
+    const auto instance = m_instanceMap.find(resolver.first);
+    table->entries.push_back(
+        {resolver.first, &resolver.second,
+         instance != m_instanceMap.end() ? &instance->second : nullptr,
+         std::binary_search(singletonKeys.begin(), singletonKeys.end(),
+                            resolver.first)});
+  }
+  // Instances inherited without their binding still resolve.
+  for (const auto& instance : m_instanceMap) {
+    if (m_resolverMap.count(instance.first) == 0) {
+      table->entries.push_back(
+          {instance.first, nullptr, &instance.second, true});
+    }
+  }
+  std::sort(table->entries.begin(), table->entries.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.key < rhs.key; });
+
+  m_resolutionTables.push_back(table);
+  m_pResolutionTable.store(table.get(), std::memory_order_release);
 }
 
 void ContextBase::HandleEvents(const void* pEvent) {
-  for (auto& iterator : m_eventHandlingList) {
-    iterator(pEvent);
+  for (size_t i = 0; i < m_eventHandlingList.size(); ++i) {
+    if (m_updateSchedules[i].IsActive()) {
+      m_eventHandlingList[i](pEvent);
+    }
   }
 
-  for (auto& child : m_childContexts) {
-    child.second->HandleEvents(pEvent);
+  ForEachChildContext([pEvent](ContextBase& child) {
+    if (child.IsActive()) {
+      child.HandleEvents(pEvent);
+    }
+  });
+}
+
+void ContextBase::SetActive(bool active) {
+  if (m_active != active) {
+    m_active = active;
+    InvalidateTraversalCaches();
+  }
+}
+
+void ContextBase::SetIsolated(bool isolated) {
+  if (m_isolated != isolated) {
+    m_isolated = isolated;
+    InvalidateTraversalCaches();
+  }
+}
+
+void ContextBase::UnsubscribeEvents(std::size_t token) {
+  for (auto& subscriptions : m_eventSubscriptions) {
+    auto& list = subscriptions.second;
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [token](const EventSubscription& subscription) {
+                                return subscription.token == token;
+                              }),
+               list.end());
   }
+  InvalidateTraversalCaches();
 }
 
 void ContextBase::PreUpdate() {
+  PreUpdateSelf();
+
+  ForEachChildContext([](ContextBase& child) {
+    if (child.IsActive() && !child.IsIsolated()) {
+      child.PreUpdate();
+    }
+  });
+
+  RunIsolatedChildren([](ContextBase& child) { child.PreUpdate(); });
+}
+
+void ContextBase::Update(double deltaTime) {
+  UpdateSelf(deltaTime);
+
+  ForEachChildContext([deltaTime](ContextBase& child) {
+    if (child.IsActive() && !child.IsIsolated()) {
+      child.Update(deltaTime);
+    }
+  });
+
+  RunIsolatedChildren(
+      [deltaTime](ContextBase& child) { child.Update(deltaTime); });
+}
+
+void ContextBase::PostUpdate() {
+  PostUpdateSelf();
+
+  ForEachChildContext([](ContextBase& child) {
+    if (child.IsActive() && !child.IsIsolated()) {
+      child.PostUpdate();
+    }
+  });
+
+  RunIsolatedChildren([](ContextBase& child) { child.PostUpdate(); });
+
+  // After the whole tree, so the frame's shared writes publish together.
+  if (m_ownsSharedStore) {
+    m_pSharedStore->Commit();
+  }
+}
+
+void ContextBase::Tick(double deltaTime) {
+  // Each phase still finishes across the whole tree before the next starts,
+  // but walks the cached flat order instead of recursing. Children added
+  // during a phase join from the next one.
+  RunTickPhase(Phase::PreUpdate, deltaTime);
+  RunTickPhase(Phase::Update, deltaTime);
+  RunTickPhase(Phase::PostUpdate, deltaTime);
+
+  if (m_ownsSharedStore) {
+    m_pSharedStore->Commit();
+  }
+}
+
+void ContextBase::RunTickPhase(Phase phase, double deltaTime) {
+  for (const auto& step : GetTickOrder()) {
+    const auto& context = step.context;
+    if (context->m_removed) {
+      continue;
+    }
+
+    if (step.isolatedChildren) {
+      // Each isolated child walks its own flat order on its worker.
+      context->RunIsolatedChildren([phase, deltaTime](ContextBase& child) {
+        child.RunTickPhase(phase, deltaTime);
+      });
+      continue;
+    }
+
+    switch (phase) {
+      case Phase::PreUpdate:
+        context->PreUpdateSelf();
+        break;
+      case Phase::Update:
+        context->UpdateSelf(deltaTime);
+        break;
+      case Phase::PostUpdate:
+        context->PostUpdateSelf();
+        break;
+    }
+  }
+}
+
+void ContextBase::RunIsolatedChildren(
+    const std::function<void(ContextBase&)>& phase) {
+  std::vector<ContextBase*> children;
+  for (auto& child : m_childContexts) {
+    if (child.second && child.second->IsActive() &&
+        child.second->IsIsolated()) {
+      children.push_back(child.second.get());
+    }
+  }
+  if (children.empty()) {
+    return;
+  }
+
+  std::vector<IsolatedDispatchGate> gates(children.size());
+  auto runChild = [&children, &gates, &phase](std::size_t index) {
+    gates[index].isolatedContext = children[index];
+    ScopedIsolation isolation(children[index], &gates[index]);
+    phase(*children[index]);
+  };
+
+  WorkStealingPool* pool = GetWorkerPool();
+  if (pool != nullptr) {
+    std::vector<WorkStealingPool::Task> tasks;
+    tasks.reserve(children.size());
+    for (std::size_t i = 0; i < children.size(); ++i) {
+      tasks.emplace_back([&runChild, i]() { runChild(i); });
+    }
+    pool->Run(tasks);
+  } else {
+    for (std::size_t i = 0; i < children.size(); ++i) {
+      runChild(i);
+    }
+  }
+
+  // Sync point, every isolated child has finished the phase.
+  for (std::size_t i = 0; i < children.size(); ++i) {
+    for (auto& dispatch : gates[i].deferred) {
+      dispatch();
+    }
+
+    if (children[i]->m_invalidateAncestorsAtSync) {
+      children[i]->m_invalidateAncestorsAtSync = false;
+      InvalidateTraversalCaches();
+    }
+  }
+}
+
+WorkStealingPool* ContextBase::GetWorkerPool() const {
+  if constexpr (ThreadingPolicy::IsSingleThreaded) {
+    return nullptr;
+  }
+  for (const ContextBase* context = this; context != nullptr;
+       context = context->m_parent) {
+    if (context->m_pWorkerPool) {
+      return context->m_pWorkerPool.get();
+    }
+  }
+  return nullptr;
+}
+
+bool ContextBase::IsolatedDispatchGate::ShouldDefer(
+    const SignalBase& signal) const {
+  // Signals created inside the isolated subtree dispatch straight away.
+  for (auto context = static_cast<const ContextBase*>(signal.GetOwner());
+       context != nullptr; context = context->m_parent) {
+    if (context == isolatedContext) {
+      return false;
+    }
+  }
+  return signal.GetOwner() != nullptr;
+}
+
+void ContextBase::IsolatedDispatchGate::Defer(std::function<void()> dispatch) {
+  deferred.push_back(std::move(dispatch));
+}
+
+void ContextBase::PreUpdateSelf() {
+  CULPRIT_PROFILE_SCOPE("PreUpdate", typeid(*this).name());
+
+  if (!m_pendingChildContexts.empty()) {
+    AttachLoadedChildContexts();
+  }
+
   for (auto& storedKey : m_toRemoveStoredObjects) {
-    m_storedObjects.erase(storedKey);
+    EraseStoredObject(storedKey);
   }
   m_toRemoveStoredObjects.clear();
+  ApplyKeyedRemovals();
 
   for (auto& updatableKey : m_toRemoveUpdatableObjects) {
     // get the element that is currently set to this updatable
@@ -124,43 +606,593 @@ void ContextBase::PreUpdate() {
       swapAndPop(m_updateList, updatableIndex);
       swapAndPop(m_eventHandlingList, updatableIndex);
       swapAndPop(m_postUpdateList, updatableIndex);
+      swapAndPop(m_updateSchedules, updatableIndex);
     }
 
-    m_updatableObjects.erase(updatableKey);
+    const auto removed = m_updatableObjects.find(updatableKey);
+    auto wrapper = std::move(removed->second.second);
+    m_updatableObjects.erase(removed);
+    RemoveEventSubscriptions(updatableKey);
+
+    // Retired after every other reference here is gone, so the reclaimer
+    // holds the last one.
+    Retire(std::move(wrapper));
   }
   m_toRemoveUpdatableObjects.clear();
 
-  Resolve<PreUpdateContextSignal>()->Dispatch();
+  m_pPreUpdateSignal->Dispatch();
 
-  for (auto& iterator : m_preUpdateList) {
-    iterator();
+  for (size_t i = 0; i < m_preUpdateList.size(); ++i) {
+    if (m_updateSchedules[i].IsActive()) {
+      m_preUpdateList[i]();
+    }
+  }
+}
+
+void ContextBase::UpdateSelf(double deltaTime) {
+  CULPRIT_PROFILE_SCOPE("Update", typeid(*this).name());
+
+  m_pUpdateSignal->Dispatch();
+
+  for (size_t i = 0; i < m_updateList.size(); ++i) {
+    double elapsedTime = deltaTime;
+    if (m_updateSchedules[i].IsActive() &&
+        m_updateSchedules[i].Advance(deltaTime, m_frameIndex, elapsedTime)) {
+      m_updateList[i](elapsedTime);
+    }
+  }
+  ++m_frameIndex;
+}
+
+void ContextBase::PostUpdateSelf() {
+  CULPRIT_PROFILE_SCOPE("PostUpdate", typeid(*this).name());
+
+  if (m_pFrameScheduler) {
+    m_pFrameScheduler->RunFrame();
+  }
+
+  if (m_pOwnedReclaimer) {
+    m_pOwnedReclaimer->RunFrame();
+  }
+
+  m_pPostUpdateSignal->Dispatch();
+
+  for (size_t i = 0; i < m_postUpdateList.size(); ++i) {
+    if (m_updateSchedules[i].IsActive()) {
+      m_postUpdateList[i]();
+    }
+  }
+
+  for (const auto publish : m_snapshotPublishers) {
+    publish(*this);
+  }
+}
+
+const std::vector<ContextBase::TickStep>& ContextBase::GetTickOrder() {
+  if (m_tickOrderDirty) {
+    m_tickOrder.clear();
+    CollectTickOrder(m_tickOrder);
+    m_tickOrderDirty = false;
   }
+  return m_tickOrder;
+}
+
+void ContextBase::CollectTickOrder(std::vector<TickStep>& order) {
+  order.push_back(TickStep{shared_from_this(), false});
 
+  bool hasIsolatedChildren = false;
   for (auto& child : m_childContexts) {
-    child.second->PreUpdate();
+    if (!child.second || !child.second->IsActive()) {
+      continue;
+    }
+
+    if (child.second->IsIsolated()) {
+      hasIsolatedChildren = true;
+    } else {
+      child.second->CollectTickOrder(order);
+    }
+  }
+
+  if (hasIsolatedChildren) {
+    order.push_back(TickStep{shared_from_this(), true});
   }
 }
 
-void ContextBase::Update(double deltaTime) {
-  Resolve<UpdateContextSignal>()->Dispatch();
+MetricsSnapshot ContextBase::SnapshotMetrics() const {
+  MetricsSnapshot snapshot;
+  snapshot.takenAt = std::chrono::steady_clock::now();
+
+  std::unordered_map<type_identifier, std::size_t> signalIndices;
+  CollectMetrics(snapshot, signalIndices, 0);
+  return snapshot;
+}
 
-  for (auto& iterator : m_updateList) {
-    iterator(deltaTime);
+void ContextBase::Retire(std::shared_ptr<void> object) {
+  if (m_pReclaimer) {
+    m_pReclaimer->Retire(std::move(object));
   }
+}
 
+void ContextBase::ForgetReclaimer() {
+  m_pReclaimer = nullptr;
   for (auto& child : m_childContexts) {
-    child.second->Update(deltaTime);
+    if (child.second) {
+      child.second->ForgetReclaimer();
+    }
+  }
+  for (auto& pool : m_childContextPools) {
+    for (auto& pooled : pool.second) {
+      pooled->ForgetReclaimer();
+    }
   }
 }
 
-void ContextBase::PostUpdate() {
-  Resolve<PostUpdateContextSignal>()->Dispatch();
+void ContextBase::MarkRemoved() {
+  m_removed = true;
+  for (auto& child : m_childContexts) {
+    if (child.second) {
+      child.second->MarkRemoved();
+    }
+  }
+}
+
+ContextBase::ChildContexts::const_iterator ContextBase::FindChildContext(
+    type_identifier contextKey) const {
+  // Children added by handle are never found by type alone.
+  return std::find_if(m_childContexts.begin(), m_childContexts.end(),
+                      [contextKey](const auto& child) {
+                        return child.first == contextKey && child.second &&
+                               child.second->m_handle == 0;
+                      });
+}
+
+struct ContextBase::ChildIterationScope {
+  explicit ChildIterationScope(ContextBase& context) : context(context) {
+    ++context.m_childIterationDepth;
+  }
+
+  ~ChildIterationScope() {
+    if (--context.m_childIterationDepth == 0 &&
+        context.m_hasErasedChildContexts) {
+      auto& children = context.m_childContexts;
+      children.erase(std::remove_if(children.begin(), children.end(),
+                                    [](const auto& child) {
+                                      return child.second == nullptr;
+                                    }),
+                     children.end());
+      context.m_hasErasedChildContexts = false;
+    }
+  }
+
+  ContextBase& context;
+};
+
+void ContextBase::ForEachChildContext(
+    const std::function<void(ContextBase&)>& visit) {
+  ChildIterationScope scope(*this);
+  // Children added during the walk join from the next one.
+  const auto count = m_childContexts.size();
+  for (std::size_t i = 0; i < count; ++i) {
+    // Held, as the visit may remove the child it is visiting.
+    const auto child = m_childContexts[i].second;
+    if (child) {
+      visit(*child);
+    }
+  }
+}
+
+void ContextBase::EraseChildContext(ChildContexts::const_iterator child) {
+  if (m_childIterationDepth > 0) {
+    m_childContexts[child - m_childContexts.cbegin()].second.reset();
+    m_hasErasedChildContexts = true;
+    return;
+  }
+  m_childContexts.erase(child);
+}
+
+void ContextBase::QueueChildContextLoad(
+    type_identifier contextKey, std::shared_ptr<ContextBase> child,
+    std::function<void(std::exception_ptr)> complete) {
+  auto load = std::make_shared<std::packaged_task<void()>>(
+      [child]() { child->Initialise(); });
+  m_pendingChildContexts.push_back(PendingChildContext{
+      contextKey, child, load->get_future(), std::move(complete)});
+
+  WorkStealingPool* pool = GetWorkerPool();
+  if (pool != nullptr) {
+    pool->Submit([load]() { (*load)(); });
+  } else {
+    (*load)();
+  }
+}
+
+void ContextBase::AttachLoadedChildContexts() {
+  // Entering a child can queue more loads, those wait for the next frame.
+  auto pendingChildContexts = std::move(m_pendingChildContexts);
+  m_pendingChildContexts.clear();
+
+  for (auto& pending : pendingChildContexts) {
+    if (pending.loaded.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      m_pendingChildContexts.push_back(std::move(pending));
+      continue;
+    }
+
+    try {
+      pending.loaded.get();
+    } catch (...) {
+      pending.complete(std::current_exception());
+      continue;
+    }
+
+    if (FindChildContext(pending.type) != m_childContexts.end()) {
+      pending.complete(std::make_exception_ptr(std::runtime_error(
+          "Cannot add the same child context twice: " +
+          std::string(typeid(*pending.context).name()))));
+      continue;
+    }
+
+    auto& child = pending.context;
+    child->m_loadingAsync = false;
+    for (const auto signalID : child->m_pendingSignalAttachments) {
+      child->AttachToInheritedSignal(signalID);
+    }
+    child->m_pendingSignalAttachments.clear();
+
+    child->m_parent = this;
+    m_childContexts.emplace_back(pending.type, child);
+    InvalidateTraversalCaches();
+    m_childContextsCreated.Add();
+
+    child->Enter();
+    pending.complete(nullptr);
+  }
+}
 
-  for (auto& iterator : m_postUpdateList) {
-    iterator();
+void ContextBase::AttachToInheritedSignal(type_identifier signalID) {
+  if (m_loadingAsync) {
+    m_pendingSignalAttachments.push_back(signalID);
+    return;
   }
 
+  const auto& signalResolver = m_resolverMap.at(signalID);
+  const auto signal = std::static_pointer_cast<SignalBase>(signalResolver());
+  const auto attachID = signal->Attach(m_commandMap.at(signalID).get(),
+                                       &SignalResponder::Respond);
+
+  // Tracked so Exit can detach it if this context is removed.
+  m_attachedCommands[signalID].push_back(attachID);
+}
+
+bool ContextBase::RemoveChildContext(ContextHandle handle) {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  if (FindChildSlot(handle) == nullptr) {
+    return false;
+  }
+
+  auto& slot = m_childSlots[static_cast<std::uint32_t>(handle) - 1];
+  auto child = std::move(slot.context);
+  const auto contextKey = slot.type;
+  ++slot.generation;
+  m_freeChildSlots.push_back(static_cast<std::uint32_t>(handle) - 1);
+
+  child->Exit();
+  for (auto& grandchild : child->m_childContexts) {
+    if (grandchild.second) {
+      grandchild.second->Exit();
+    }
+  }
+
+  EraseChildContext(std::find_if(
+      m_childContexts.begin(), m_childContexts.end(),
+      [&child](const auto& entry) { return entry.second == child; }));
+
+  child->m_parent = nullptr;
+  child->MarkRemoved();
+  child->m_handle = 0;
+  m_childContextPools[contextKey].push_back(std::move(child));
+
+  InvalidateTraversalCaches();
+  m_childContextsDestroyed.Add();
+  return true;
+}
+
+std::shared_ptr<ContextBase> ContextBase::TakePooledChildContext(
+    type_identifier contextKey) {
+  const auto pool = m_childContextPools.find(contextKey);
+  if (pool == m_childContextPools.end() || pool->second.empty()) {
+    return nullptr;
+  }
+
+  auto child = std::move(pool->second.back());
+  pool->second.pop_back();
+  child->Recycle(*this);
+  return child;
+}
+
+ContextHandle ContextBase::AttachChildContextInstance(
+    type_identifier contextKey, std::shared_ptr<ContextBase> child) {
+  std::uint32_t index;
+  if (m_freeChildSlots.empty()) {
+    index = static_cast<std::uint32_t>(m_childSlots.size());
+    m_childSlots.emplace_back();
+  } else {
+    index = m_freeChildSlots.back();
+    m_freeChildSlots.pop_back();
+  }
+
+  // Low half is the slot index plus one, so no handle is zero.
+  auto& slot = m_childSlots[index];
+  const auto handle =
+      (static_cast<ContextHandle>(slot.generation) << 32) | (index + 1);
+  slot.context = child;
+  slot.type = contextKey;
+
+  child->m_parent = this;
+  child->m_handle = handle;
+  m_childContexts.emplace_back(contextKey, std::move(child));
+  InvalidateTraversalCaches();
+  return handle;
+}
+
+const ContextBase::ChildSlot* ContextBase::FindChildSlot(
+    ContextHandle handle) const {
+  const auto index = static_cast<std::uint32_t>(handle);
+  if (index == 0 || index > m_childSlots.size()) {
+    return nullptr;
+  }
+
+  const auto& slot = m_childSlots[index - 1];
+  if (!slot.context || slot.generation != (handle >> 32)) {
+    return nullptr;
+  }
+  return &slot;
+}
+
+void ContextBase::Recycle(const ContextBase& parent) {
+  std::lock_guard<ThreadingPolicy::RecursiveMutex> lock(m_mutationMutex);
+  // Removed contexts aren't resolved from other threads, so only the table
+  // that was current needs keeping until Build publishes the next.
+  m_pResolutionTable.store(nullptr, std::memory_order_release);
+  m_resolutionTables.erase(
+      m_resolutionTables.begin(),
+      m_resolutionTables.end() - std::min<std::size_t>(
+                                     1, m_resolutionTables.size()));
+
+  // Bindings, command chains and signal responders built by the first
+  // Initialise are kept, everything created from them starts over.
   for (auto& child : m_childContexts) {
-    child.second->PostUpdate();
+    if (child.second) {
+      child.second->m_parent = nullptr;
+    }
+  }
+  m_childContexts.clear();
+  m_hasErasedChildContexts = false;
+  m_childSlots.clear();
+  m_freeChildSlots.clear();
+  m_childContextPools.clear();
+
+  m_instanceMap = parent.m_instanceMap;
+  m_pSharedStore = parent.m_pSharedStore;
+  for (const auto key : asSingletonKeys) {
+    m_instanceMap.erase(key);
+  }
+  // Keys this context binds over the parent's stay shadowed.
+  for (const auto& resolver : m_resolverMap) {
+    if (resolver.second.owner == this) {
+      m_instanceMap.erase(resolver.first);
+    }
+  }
+  m_instanceMap.erase(UniqueKeyGenerator::Get<ContextBase>());
+
+  for (const auto& size : m_storedObjectSizes) {
+    m_storedBytes.Add(-static_cast<std::int64_t>(size.second));
+  }
+  m_storedObjectSizes.clear();
+  m_storedObjects.clear();
+  m_toRemoveStoredObjects.clear();
+  for (const auto& store : m_keyedStores) {
+    m_storedBytes.Add(-static_cast<std::int64_t>(
+        store.second->size() * store.second->GetValueSize()));
+  }
+  m_keyedStores.clear();
+  m_toApplyKeyedRemovals.clear();
+
+  m_updatableObjects.clear();
+  m_toRemoveUpdatableObjects.clear();
+  m_preUpdateList.clear();
+  m_updateList.clear();
+  m_eventHandlingList.clear();
+  m_postUpdateList.clear();
+  m_updateSchedules.clear();
+  m_reducedRateSlots = 0;
+  m_frameIndex = 0;
+
+  m_eventSubscriptions.clear();
+  m_eventRoutes.clear();
+
+  m_active = true;
+  m_removed = false;
+  m_isolated = false;
+  m_invalidateAncestorsAtSync = false;
+  m_pWorkerPool.reset();
+  m_tickOrderDirty = true;
+
+  // Before Build, so the singletons it creates don't pick up any state of
+  // the previous use.
+  OnRecycle();
+  Build();
+
+  // Exit detached the responders on signals inherited from the parent.
+  for (auto& attached : m_attachedCommands) {
+    const auto& signalResolver = m_resolverMap.at(attached.first);
+    const auto signal = std::static_pointer_cast<SignalBase>(signalResolver());
+    auto responder = m_commandMap.at(attached.first).get();
+    for (auto& attachID : attached.second) {
+      attachID = signal->Attach(responder, &SignalResponder::Respond);
+    }
+  }
+
+  m_pEnterSignal = Resolve<EnterContextSignal>();
+  m_pExitSignal = Resolve<ExitContextSignal>();
+  m_pPreUpdateSignal = Resolve<PreUpdateContextSignal>();
+  m_pUpdateSignal = Resolve<UpdateContextSignal>();
+  m_pPostUpdateSignal = Resolve<PostUpdateContextSignal>();
+  if (m_pFrameScheduler) {
+    m_pFrameScheduler = Resolve<FrameScheduler>();
+  }
+  m_pReclaimer = parent.m_pReclaimer;
+}
+
+void ContextBase::EraseStoredObject(type_identifier storedKey) {
+  const auto stored = m_storedObjects.find(storedKey);
+  if (stored == m_storedObjects.end()) {
+    return;
+  }
+  Retire(std::move(stored->second));
+  m_storedObjects.erase(stored);
+
+  const auto size = m_storedObjectSizes.find(storedKey);
+  if (size != m_storedObjectSizes.end()) {
+    m_storedBytes.Add(-static_cast<std::int64_t>(size->second));
+    m_storedObjectSizes.erase(size);
+  }
+}
+
+void ContextBase::ApplyKeyedRemovals() {
+  for (auto* store : m_toApplyKeyedRemovals) {
+    const auto removed = store->ApplyRemovals();
+    m_storedBytes.Add(-static_cast<std::int64_t>(removed *
+                                                 store->GetValueSize()));
+  }
+  m_toApplyKeyedRemovals.clear();
+}
+
+void ContextBase::CollectMetrics(
+    MetricsSnapshot& snapshot,
+    std::unordered_map<type_identifier, std::size_t>& signalIndices,
+    std::size_t depth) const {
+  snapshot.singletonResolves += m_singletonResolves.Read();
+  snapshot.transientResolves += m_transientResolves.Read();
+  snapshot.childContextsCreated += m_childContextsCreated.Read();
+  snapshot.childContextsDestroyed += m_childContextsDestroyed.Read();
+  snapshot.storedBytes += m_storedBytes.Read();
+
+  snapshot.contexts.push_back(
+      ContextMetrics{typeid(*this).name(), depth, m_updateList.size()});
+
+  for (const auto& signalType : m_signalTypes) {
+    const auto instance = m_instanceMap.find(signalType.first);
+    if (instance == m_instanceMap.end()) {
+      continue;
+    }
+
+    const auto signal = static_cast<const SignalBase*>(instance->second.get());
+    const auto index = signalIndices.find(signalType.first);
+    if (index == signalIndices.end()) {
+      signalIndices.insert(
+          std::make_pair(signalType.first, snapshot.signals.size()));
+      snapshot.signals.push_back(
+          SignalMetrics{signalType.second, signal->GetDispatchCount()});
+    } else {
+      snapshot.signals[index->second].dispatches += signal->GetDispatchCount();
+    }
+  }
+
+  for (const auto& responder : m_commandMap) {
+    const auto started = responder.second->GetChainsStarted();
+    const auto completed = responder.second->GetChainsCompleted();
+    snapshot.commandChainsStarted += started;
+    snapshot.commandsExecuted += responder.second->GetCommandsExecuted();
+    if (started > completed) {
+      snapshot.pendingCommandChains += started - completed;
+    }
+  }
+
+  for (const auto& child : m_childContexts) {
+    if (child.second) {
+      child.second->CollectMetrics(snapshot, signalIndices, depth + 1);
+    }
+  }
+}
+
+std::size_t ContextBase::AddEventSubscription(
+    type_identifier eventID, type_identifier owner,
+    std::shared_ptr<EventHandler> handler) {
+  const auto token = m_nextEventToken++;
+  m_eventSubscriptions[eventID].push_back(
+      EventSubscription{owner, token, std::move(handler)});
+  InvalidateTraversalCaches();
+  return token;
+}
+
+void ContextBase::RemoveEventSubscriptions(type_identifier owner) {
+  bool removed = false;
+  for (auto& subscriptions : m_eventSubscriptions) {
+    auto& list = subscriptions.second;
+    const auto size = list.size();
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [owner](const EventSubscription& subscription) {
+                                return subscription.owner == owner;
+                              }),
+               list.end());
+    removed = removed || list.size() != size;
+  }
+
+  if (removed) {
+    InvalidateTraversalCaches();
+  }
+}
+
+std::shared_ptr<const ContextBase::EventRoute> ContextBase::GetEventRoute(
+    type_identifier eventID) {
+  const auto cached = m_eventRoutes.find(eventID);
+  if (cached != m_eventRoutes.end()) {
+    return cached->second;
+  }
+
+  auto route = std::make_shared<EventRoute>();
+  CollectEventHandlers(eventID, *route);
+  m_eventRoutes.insert(std::make_pair(eventID, route));
+  return route;
+}
+
+void ContextBase::CollectEventHandlers(type_identifier eventID,
+                                       EventRoute& route) const {
+  const auto subscriptions = m_eventSubscriptions.find(eventID);
+  if (subscriptions != m_eventSubscriptions.end()) {
+    for (const auto& subscription : subscriptions->second) {
+      if (subscription.owner != 0) {
+        const auto updatable = m_updatableObjects.find(subscription.owner);
+        if (updatable == m_updatableObjects.end() ||
+            !m_updateSchedules[updatable->second.first].IsActive()) {
+          continue;
+        }
+      }
+      route.push_back(subscription.handler);
+    }
+  }
+
+  for (const auto& child : m_childContexts) {
+    if (child.second && child.second->IsActive()) {
+      child.second->CollectEventHandlers(eventID, route);
+    }
+  }
+}
+
+void ContextBase::InvalidateTraversalCaches() {
+  // Every ancestor may have cached a route or tick order that passes through
+  // here.
+  for (ContextBase* context = this; context != nullptr;
+       context = context->m_parent) {
+    context->m_eventRoutes.clear();
+    context->m_tickOrderDirty = true;
+
+    // Ancestors of an isolated child mid phase are shared with its siblings'
+    // threads, so they are left to the sync point.
+    if (context == t_isolatedContext) {
+      context->m_invalidateAncestorsAtSync = true;
+      break;
+    }
   }
 }
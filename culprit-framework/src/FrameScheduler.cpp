@@ -0,0 +1,60 @@
+#include "culprit-framework/FrameScheduler.h"
+
+#include <algorithm>
+
+using culprit::framework::FrameScheduler;
+using culprit::framework::ThreadingPolicy;
+
+namespace {
+auto toMicroseconds = [](auto duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+};
+}  // namespace
+
+void FrameScheduler::Schedule(Job job) {
+  QueuedJob queued{std::move(job), Clock::now()};
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_jobsMutex);
+  m_jobs.push_back(std::move(queued));
+}
+
+void FrameScheduler::RunFrame() {
+  FrameSchedulerReport report;
+
+  const auto frameStart = Clock::now();
+  const auto deadline = frameStart + m_frameBudget;
+  auto now = frameStart;
+  Clock::duration totalLatency{0};
+
+  std::size_t runnable = GetPendingCount();
+  while (runnable > 0 && (report.jobsRun == 0 || now < deadline)) {
+    QueuedJob queued;
+    {
+      // Not held while the job runs, so jobs can schedule more work.
+      std::lock_guard<ThreadingPolicy::Mutex> lock(m_jobsMutex);
+      queued = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    --runnable;
+
+    const auto latency = now - queued.queuedAt;
+    totalLatency += latency;
+    report.maxQueueLatency =
+        std::max(report.maxQueueLatency, toMicroseconds(latency));
+
+    queued.job();
+    ++report.jobsRun;
+    now = Clock::now();
+  }
+
+  report.jobsPending = GetPendingCount();
+  report.elapsed = toMicroseconds(now - frameStart);
+  if (now > deadline) {
+    report.overrun = toMicroseconds(now - deadline);
+  }
+  if (report.jobsRun > 0) {
+    report.averageQueueLatency =
+        toMicroseconds(totalLatency / static_cast<int>(report.jobsRun));
+  }
+
+  m_lastFrameReport = report;
+}
@@ -0,0 +1,166 @@
+#include "culprit-framework/Profiler.h"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using culprit::framework::ProfileEvent;
+using culprit::framework::Profiler;
+
+namespace {
+struct ThreadBuffer {
+  explicit ThreadBuffer(std::size_t eventCapacity, std::size_t id)
+      : events{new ProfileEvent[eventCapacity]},
+        capacity{eventCapacity},
+        threadID{id} {}
+
+  std::unique_ptr<ProfileEvent[]> events;
+  const std::size_t capacity;
+  const std::size_t threadID;
+  // Published with release so the exporter never sees a half written event.
+  std::atomic<std::size_t> count{0};
+  std::atomic<std::size_t> dropped{0};
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::size_t threadBufferCapacity{1 << 16};
+  const Profiler::Clock::time_point origin{Profiler::Clock::now()};
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+ThreadBuffer& GetThreadBuffer() {
+  // The registry keeps the buffer alive after the thread exits so its events
+  // are still exported.
+  thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto newBuffer = std::make_shared<ThreadBuffer>(
+        registry.threadBufferCapacity, registry.buffers.size() + 1);
+    registry.buffers.push_back(newBuffer);
+    return newBuffer;
+  }();
+  return *buffer;
+}
+
+void WriteJsonString(std::ostream& out, const char* text) {
+  out << '"';
+  for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c) {
+    switch (*c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(*c) >= 0x20) {
+          out << *c;
+        }
+        break;
+    }
+  }
+  out << '"';
+}
+}  // namespace
+
+void Profiler::Record(const char* category, const char* name,
+                      Clock::time_point start, Clock::time_point end,
+                      std::int64_t arg) {
+  auto& buffer = GetThreadBuffer();
+  const auto index = buffer.count.load(std::memory_order_relaxed);
+  if (index >= buffer.capacity) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto origin = GetRegistry().origin;
+  auto& event = buffer.events[index];
+  event.category = category;
+  event.name = name;
+  event.startNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin)
+          .count();
+  event.durationNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  event.arg = arg;
+
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& buffer : registry.buffers) {
+    const auto count = buffer->count.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto& event = buffer->events[i];
+      out << (first ? "\n" : ",\n") << "{\"name\":";
+      WriteJsonString(out, event.name);
+      out << ",\"cat\":";
+      WriteJsonString(out, event.category);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadID
+          << ",\"ts\":" << event.startNs / 1000.0
+          << ",\"dur\":" << event.durationNs / 1000.0;
+      if (event.arg >= 0) {
+        out << ",\"args\":{\"value\":" << event.arg << "}";
+      }
+      out << "}";
+      first = false;
+    }
+  }
+  out << "\n]}\n";
+
+  return static_cast<bool>(out);
+}
+
+void Profiler::Clear() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& buffer : registry.buffers) {
+    buffer->count.store(0, std::memory_order_release);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Profiler::SetThreadBufferCapacity(std::size_t eventCount) {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threadBufferCapacity = eventCount;
+}
+
+std::size_t Profiler::GetRecordedCount() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::size_t total = 0;
+  for (const auto& buffer : registry.buffers) {
+    total += buffer->count.load(std::memory_order_acquire);
+  }
+  return total;
+}
+
+std::size_t Profiler::GetDroppedCount() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::size_t total = 0;
+  for (const auto& buffer : registry.buffers) {
+    total += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
@@ -0,0 +1,111 @@
+#include "culprit-framework/Reclaimer.h"
+
+#include <cassert>
+
+using culprit::framework::Reclaimer;
+using culprit::framework::ThreadingPolicy;
+
+Reclaimer::Reclaimer(Mode mode, std::chrono::microseconds frameBudget)
+    : m_mode{mode}, m_frameBudget{frameBudget} {
+#if defined(CULPRIT_SINGLE_THREADED)
+  assert(m_mode == Mode::Budgeted &&
+         "Background reclamation needs a multi-threaded build.");
+#else
+  if (m_mode == Mode::Background) {
+    m_thread = std::thread([this]() { RunBackground(); });
+  }
+#endif
+}
+
+Reclaimer::~Reclaimer() {
+#if !defined(CULPRIT_SINGLE_THREADED)
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard<ThreadingPolicy::Mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_one();
+    // Never join from the thread itself, as when the last owner was released
+    // there.
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+      m_thread.detach();
+    } else {
+      m_thread.join();
+    }
+  }
+#endif
+
+  Drain();
+}
+
+void Reclaimer::Retire(std::shared_ptr<void> object) {
+  if (!object) {
+    return;
+  }
+
+  {
+    std::lock_guard<ThreadingPolicy::Mutex> lock(m_mutex);
+    m_retired.push_back(std::move(object));
+  }
+#if !defined(CULPRIT_SINGLE_THREADED)
+  if (m_mode == Mode::Background) {
+    m_wake.notify_one();
+  }
+#endif
+}
+
+void Reclaimer::RunFrame() {
+  if (m_mode != Mode::Budgeted) {
+    return;
+  }
+
+  const auto deadline = Clock::now() + m_frameBudget;
+  if (!ReleaseOne()) {
+    return;
+  }
+  while (Clock::now() < deadline && ReleaseOne()) {
+  }
+}
+
+void Reclaimer::Drain() {
+  while (ReleaseOne()) {
+  }
+}
+
+std::size_t Reclaimer::GetPendingCount() const {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_mutex);
+  return m_retired.size();
+}
+
+bool Reclaimer::ReleaseOne() {
+  std::shared_ptr<void> object;
+  {
+    std::lock_guard<ThreadingPolicy::Mutex> lock(m_mutex);
+    if (m_retired.empty()) {
+      return false;
+    }
+    object = std::move(m_retired.front());
+    m_retired.pop_front();
+  }
+
+  // Released outside the lock, a destructor may retire more objects.
+  object.reset();
+  m_releasedCount.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void Reclaimer::RunBackground() {
+#if !defined(CULPRIT_SINGLE_THREADED)
+  std::unique_lock<ThreadingPolicy::Mutex> lock(m_mutex);
+  while (true) {
+    m_wake.wait(lock, [this]() { return m_stopping || !m_retired.empty(); });
+    if (m_stopping) {
+      return;
+    }
+
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+#endif
+}
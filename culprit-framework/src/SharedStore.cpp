@@ -0,0 +1,147 @@
+#include "culprit-framework/SharedStore.h"
+
+#include <algorithm>
+#include <mutex>
+
+using culprit::framework::SharedStore;
+using culprit::framework::ThreadingPolicy;
+
+namespace {
+template <class Entries>
+auto LowerBound(Entries& entries, std::size_t key) {
+  return std::lower_bound(
+      entries.begin(), entries.end(), key,
+      [](const auto& entry, std::size_t value) { return entry.key < value; });
+}
+}  // namespace
+
+SharedStore::SharedStore() {
+  m_snapshots.push_back(std::make_unique<Snapshot>());
+  m_current = m_snapshots.back().get();
+  m_pPublished.store(m_current);
+}
+
+SharedStore::~SharedStore() = default;
+
+std::shared_ptr<void> SharedStore::Find(std::size_t key) const {
+  const auto* snapshot = Pin();
+  const auto* entry = snapshot->Find(key);
+  auto value = entry != nullptr ? entry->value : nullptr;
+  Unpin(snapshot);
+  return value;
+}
+
+std::uint64_t SharedStore::GetVersion() const {
+  const auto* snapshot = Pin();
+  const auto version = snapshot->version;
+  Unpin(snapshot);
+  return version;
+}
+
+const SharedStore::Snapshot* SharedStore::Pin() const {
+  for (;;) {
+    const auto* snapshot = m_pPublished.load();
+    // Pinned only if it is still the published one once counted, otherwise
+    // a commit may already be refilling it.
+    snapshot->readers.fetch_add(1);
+    if (m_pPublished.load() == snapshot) {
+      return snapshot;
+    }
+    snapshot->readers.fetch_sub(1);
+  }
+}
+
+void SharedStore::Unpin(const Snapshot* snapshot) {
+  snapshot->readers.fetch_sub(1);
+}
+
+void SharedStore::Put(std::size_t key, std::shared_ptr<void> value) {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_writeMutex);
+  // A put after a removal in the same batch replaces the removed object.
+  m_removed.erase(std::remove(m_removed.begin(), m_removed.end(), key),
+                  m_removed.end());
+
+  const auto staged = LowerBound(m_staged, key);
+  if (staged != m_staged.end() && staged->key == key) {
+    staged->value = std::move(value);
+  } else {
+    m_staged.insert(staged, Entry{key, std::move(value)});
+  }
+}
+
+void SharedStore::Remove(std::size_t key) {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_writeMutex);
+  m_removed.push_back(key);
+}
+
+std::shared_ptr<void> SharedStore::FindStaged(std::size_t key) const {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_writeMutex);
+  if (std::find(m_removed.begin(), m_removed.end(), key) != m_removed.end()) {
+    return nullptr;
+  }
+
+  const auto staged = LowerBound(m_staged, key);
+  if (staged != m_staged.end() && staged->key == key) {
+    return staged->value;
+  }
+
+  // Only the writer replaces the published snapshot, and it holds the lock.
+  const auto* entry = m_current->Find(key);
+  return entry != nullptr ? entry->value : nullptr;
+}
+
+bool SharedStore::HasStagedWrites() const {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_writeMutex);
+  return !m_staged.empty() || !m_removed.empty();
+}
+
+void SharedStore::Commit() {
+  std::lock_guard<ThreadingPolicy::Mutex> lock(m_writeMutex);
+  // Releases the objects held by replaced snapshots nobody is reading.
+  Snapshot* next = nullptr;
+  for (auto& snapshot : m_snapshots) {
+    if (snapshot.get() != m_current && snapshot->readers.load() == 0) {
+      snapshot->entries.clear();
+      next = snapshot.get();
+    }
+  }
+  if (m_staged.empty() && m_removed.empty()) {
+    return;
+  }
+
+  if (next == nullptr) {
+    m_snapshots.push_back(std::make_unique<Snapshot>());
+    next = m_snapshots.back().get();
+  }
+
+  std::sort(m_removed.begin(), m_removed.end());
+  next->version = m_current->version + 1;
+  next->entries.reserve(m_current->entries.size() + m_staged.size());
+
+  // Both are sorted, so merge them with the staged value winning.
+  auto current = m_current->entries.begin();
+  auto staged = m_staged.begin();
+  while (current != m_current->entries.end() || staged != m_staged.end()) {
+    const bool takeStaged =
+        current == m_current->entries.end() ||
+        (staged != m_staged.end() && staged->key <= current->key);
+    if (takeStaged && current != m_current->entries.end() &&
+        current->key == staged->key) {
+      ++current;
+    }
+    const Entry& entry = takeStaged ? *staged++ : *current++;
+    if (!std::binary_search(m_removed.begin(), m_removed.end(), entry.key)) {
+      next->entries.push_back(entry);
+    }
+  }
+  m_staged.clear();
+  m_removed.clear();
+
+  m_pPublished.store(next);
+  m_current = next;
+}
+
+const SharedStore::Entry* SharedStore::Snapshot::Find(std::size_t key) const {
+  const auto found = LowerBound(entries, key);
+  return found != entries.end() && found->key == key ? &*found : nullptr;
+}
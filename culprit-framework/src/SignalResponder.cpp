@@ -1,11 +1,14 @@
 ﻿#include "culprit-framework/SignalResponder.h"
 
+#include "culprit-framework/AllocationTracker.h"
 #include "culprit-framework/CommandBase.h"
+#include "culprit-framework/Profiler.h"
 
 using culprit::framework::SignalResponder;
 
 void SignalResponder::Respond() {
   m_commandIndex = 0;
+  m_chainsStarted.Add();
 
   ExecuteCommand();
 }
@@ -19,18 +22,24 @@ void SignalResponder::OnCommandReleased() {
 }
 
 void SignalResponder::ExecuteCommand() {
+  CULPRIT_ALLOCATION_SCOPE(Command);
   if (m_commandIndex < m_commands.size()) {
-    const auto commandCreatorFunction =
-        *m_commandResolverMap.at(m_commands[m_commandIndex]);
+    const auto& commandResolver =
+        m_commandResolverMap.at(m_commands[m_commandIndex]);
     currentCommand =
-        std::static_pointer_cast<CommandBase>(commandCreatorFunction());
+        std::static_pointer_cast<CommandBase>(commandResolver());
     attachToken = currentCommand->Attach<SignalResponder>(
         this, &SignalResponder::OnCommandReleased);
 
-    const auto signalCreatorFunction = *m_resolverMap.at(m_signalID);
+    const auto& signalResolver = m_resolverMap.at(m_signalID);
     const auto triggeringSignal =
-        std::static_pointer_cast<SignalBase>(signalCreatorFunction());
+        std::static_pointer_cast<SignalBase>(signalResolver());
+    CULPRIT_PROFILE_SCOPE_ARG("Execute", typeid(*currentCommand).name(),
+                              m_commandIndex);
+    m_commandsExecuted.Add();
     currentCommand->Execute(triggeringSignal);
+  } else {
+    m_chainsCompleted.Add();
   }
 }
 
@@ -38,3 +47,15 @@ void SignalResponder::AddCommand(
     std::size_t commandID) {
   m_commands.push_back(commandID);
 }
+
+std::uint64_t SignalResponder::GetChainsStarted() const {
+  return static_cast<std::uint64_t>(m_chainsStarted.Read());
+}
+
+std::uint64_t SignalResponder::GetChainsCompleted() const {
+  return static_cast<std::uint64_t>(m_chainsCompleted.Read());
+}
+
+std::uint64_t SignalResponder::GetCommandsExecuted() const {
+  return static_cast<std::uint64_t>(m_commandsExecuted.Read());
+}
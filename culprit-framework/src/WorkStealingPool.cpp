@@ -0,0 +1,161 @@
+#include "culprit-framework/WorkStealingPool.h"
+
+#include <exception>
+
+using culprit::framework::WorkStealingPool;
+
+namespace {
+// Index of the pool queue owned by the current thread, or npos on threads
+// that are not pool workers.
+thread_local std::size_t t_workerQueue = static_cast<std::size_t>(-1);
+thread_local const WorkStealingPool* t_workerPool = nullptr;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = 1;
+  }
+
+  m_queues.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; ++i) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+
+  m_threads.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; ++i) {
+    m_threads.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::Submit(Task task) {
+  const auto index =
+      m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+  {
+    std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_back(std::move(task));
+  }
+
+  {
+    // Taken so a worker between checking the count and sleeping can't miss
+    // the wake up.
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_queuedTasks.fetch_add(1, std::memory_order_release);
+  }
+  m_wake.notify_one();
+}
+
+void WorkStealingPool::Run(std::vector<Task>& tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  std::atomic<std::size_t> remaining{tasks.size()};
+  std::exception_ptr firstError;
+  // Guards firstError, and the last task's notify so the caller can't return
+  // while it is still using done.
+  std::mutex doneMutex;
+  std::condition_variable done;
+
+  for (auto& task : tasks) {
+    Submit([&task, &remaining, &firstError, &doneMutex, &done]() {
+      std::exception_ptr error;
+      try {
+        task();
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(doneMutex);
+      if (error && !firstError) {
+        firstError = error;
+      }
+      if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        done.notify_one();
+      }
+    });
+  }
+
+  // Helps while there is queued work, then sleeps until the tasks still
+  // running on other threads finish.
+  const auto callerQueue = GetCallerQueue();
+  while (remaining.load(std::memory_order_acquire) > 0 &&
+         TryRunOne(callerQueue)) {
+  }
+  {
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&remaining]() {
+      return remaining.load(std::memory_order_acquire) == 0;
+    });
+  }
+
+  if (firstError) {
+    std::rethrow_exception(firstError);
+  }
+}
+
+void WorkStealingPool::WorkerLoop(std::size_t index) {
+  t_workerQueue = index;
+  t_workerPool = this;
+
+  while (true) {
+    if (TryRunOne(index)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wake.wait(lock, [this]() {
+      return m_stopping || m_queuedTasks.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stopping && m_queuedTasks.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::TryRunOne(std::size_t preferredQueue) {
+  Task task;
+
+  // Newest first from our own queue, it is most likely still in cache.
+  {
+    auto& own = *m_queues[preferredQueue];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+
+  // Oldest first when stealing, leaving the owner its most recent work.
+  for (std::size_t offset = 1; !task && offset < m_queues.size(); ++offset) {
+    auto& victim = *m_queues[(preferredQueue + offset) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+
+  if (!task) {
+    return false;
+  }
+
+  m_queuedTasks.fetch_sub(1, std::memory_order_acq_rel);
+  task();
+  return true;
+}
+
+std::size_t WorkStealingPool::GetCallerQueue() const {
+  return t_workerPool == this ? t_workerQueue : 0;
+}
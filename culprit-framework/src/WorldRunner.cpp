@@ -0,0 +1,458 @@
+#include "culprit-framework/WorldRunner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+using culprit::framework::ContextBase;
+using culprit::framework::ShardUtilisation;
+using culprit::framework::WorldRunner;
+
+namespace {
+auto toMicroseconds = [](auto duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+};
+
+WorldRunner::Clock::duration IntervalFor(double tickRate) {
+  assert(tickRate > 0.0);
+  return std::chrono::duration_cast<WorldRunner::Clock::duration>(
+      std::chrono::duration<double>(1.0 / tickRate));
+}
+}  // namespace
+
+WorldRunner::WorldRunner(std::size_t shardCount, bool pinShards)
+    : m_pinShards{pinShards} {
+  if (shardCount == 0) {
+    shardCount = 1;
+  }
+
+  m_shards.reserve(shardCount);
+  for (std::size_t i = 0; i < shardCount; ++i) {
+    m_shards.push_back(std::make_unique<Shard>());
+  }
+}
+
+WorldRunner::~WorldRunner() { Stop(); }
+
+void WorldRunner::SetErrorHandler(ErrorHandler handler) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  assert((ignore_result("Set the error handler before Start."), !m_running));
+  m_errorHandler = std::move(handler);
+}
+
+void WorldRunner::Start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_running) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < m_shards.size(); ++i) {
+    m_shards[i]->stopping = false;
+    m_shards[i]->thread = std::thread([this, i]() { RunShard(i); });
+  }
+  m_running = true;
+}
+
+void WorldRunner::Stop() {
+  // Joined without the lock, as a world or the error handler may be waiting
+  // on it to finish its tick.
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) {
+      return;
+    }
+
+    for (auto& shard : m_shards) {
+      {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        shard->stopping = true;
+      }
+      shard->wake.notify_one();
+      if (shard->thread.joinable()) {
+        threads.push_back(std::move(shard->thread));
+      }
+    }
+  }
+
+  for (auto& thread : threads) {
+    assert((ignore_result("Stop can't be called from a shard's thread."),
+            thread.get_id() != std::this_thread::get_id()));
+    thread.join();
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_running = false;
+}
+
+WorldRunner::WorldHandle WorldRunner::AddWorld(
+    std::shared_ptr<ContextBase> world, double tickRate) {
+  assert(world != nullptr);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::vector<std::size_t> worldCounts(m_shards.size(), 0);
+  for (const auto& worldShard : m_worldShards) {
+    ++worldCounts[worldShard.second];
+  }
+  const auto shardIndex = static_cast<std::size_t>(
+      std::min_element(worldCounts.begin(), worldCounts.end()) -
+      worldCounts.begin());
+
+  const auto handle = m_nextHandle++;
+  const auto interval = IntervalFor(tickRate);
+
+  auto& shard = *m_shards[shardIndex];
+  {
+    std::lock_guard<std::mutex> shardLock(shard.mutex);
+    shard.worlds.push_back(World{handle, std::move(world), interval,
+                                 1.0 / tickRate, Clock::now()});
+    ++shard.worldsVersion;
+  }
+  shard.wake.notify_one();
+
+  m_worldShards.insert(std::make_pair(handle, shardIndex));
+  return handle;
+}
+
+bool WorldRunner::RemoveWorld(WorldHandle handle) {
+  std::shared_ptr<ContextBase> context;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto worldShard = m_worldShards.find(handle);
+    if (worldShard == m_worldShards.end()) {
+      return false;
+    }
+
+    auto& shard = *m_shards[worldShard->second];
+    std::unique_lock<std::mutex> shardLock(shard.mutex);
+    WaitForTick(shard, shardLock, handle);
+    auto world = FindWorld(shard, handle);
+    context = std::move(world->context);
+    shard.worlds.erase(world);
+    ++shard.worldsVersion;
+    m_worldShards.erase(worldShard);
+  }
+
+  context->Exit();
+  return true;
+}
+
+void WorldRunner::SetTickRate(WorldHandle handle, double tickRate) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& shard = GetShard(handle);
+
+  {
+    std::lock_guard<std::mutex> shardLock(shard.mutex);
+    auto world = FindWorld(shard, handle);
+    world->interval = IntervalFor(tickRate);
+    world->deltaTime = 1.0 / tickRate;
+    world->nextTick = std::min(world->nextTick, Clock::now() + world->interval);
+  }
+  shard.wake.notify_one();
+}
+
+std::uint64_t WorldRunner::GetTickCount(WorldHandle handle) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& shard = GetShard(handle);
+
+  std::lock_guard<std::mutex> shardLock(shard.mutex);
+  return FindWorld(shard, handle)->ticks;
+}
+
+std::size_t WorldRunner::GetShardOf(WorldHandle handle) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto worldShard = m_worldShards.find(handle);
+  if (worldShard == m_worldShards.end()) {
+    throw std::runtime_error("No world with handle " + std::to_string(handle));
+  }
+  return worldShard->second;
+}
+
+void WorldRunner::MigrateWorld(WorldHandle handle, std::size_t shardIndex) {
+  assert((ignore_result("Shard index out of range."),
+          shardIndex < m_shards.size()));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto worldShard = m_worldShards.find(handle);
+  if (worldShard == m_worldShards.end()) {
+    throw std::runtime_error("No world with handle " + std::to_string(handle));
+  }
+  if (worldShard->second == shardIndex) {
+    return;
+  }
+
+  auto& from = *m_shards[worldShard->second];
+  auto& to = *m_shards[shardIndex];
+  {
+    // Waits for the world's tick, if it is mid-tick, with only its shard
+    // locked.
+    std::unique_lock<std::mutex> fromLock(from.mutex, std::defer_lock);
+    std::unique_lock<std::mutex> toLock(to.mutex, std::defer_lock);
+    std::lock(fromLock, toLock);
+    while (from.ticking == handle) {
+      toLock.unlock();
+      WaitForTick(from, fromLock, handle);
+      fromLock.unlock();
+      std::lock(fromLock, toLock);
+    }
+
+    auto world = FindWorld(from, handle);
+    to.worlds.push_back(std::move(*world));
+    from.worlds.erase(world);
+    ++from.worldsVersion;
+    ++to.worldsVersion;
+  }
+  to.wake.notify_one();
+
+  worldShard->second = shardIndex;
+}
+
+std::vector<ShardUtilisation> WorldRunner::SampleUtilisation() {
+  std::vector<ShardUtilisation> samples;
+  samples.reserve(m_shards.size());
+
+  const auto now = Clock::now();
+  for (auto& shard : m_shards) {
+    std::lock_guard<std::mutex> shardLock(shard->mutex);
+
+    ShardUtilisation sample;
+    sample.worlds = shard->worlds.size();
+    sample.ticks = shard->ticks;
+    sample.busy = toMicroseconds(shard->busy);
+    const std::chrono::duration<double> window = now - shard->windowStart;
+    if (window.count() > 0.0) {
+      sample.utilisation = std::min(
+          1.0, std::chrono::duration<double>(shard->busy).count() /
+                   window.count());
+    }
+    samples.push_back(sample);
+
+    shard->windowStart = now;
+    shard->busy = Clock::duration{0};
+    shard->ticks = 0;
+    for (auto& world : shard->worlds) {
+      world.busy = Clock::duration{0};
+    }
+  }
+
+  return samples;
+}
+
+void WorldRunner::Rebalance() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // Every shard stays locked while worlds move, so the costs can't change
+  // under the plan.
+  std::vector<std::unique_lock<std::mutex>> shardLocks;
+  shardLocks.reserve(m_shards.size());
+  for (auto& shard : m_shards) {
+    shardLocks.emplace_back(shard->mutex);
+  }
+
+  std::vector<Clock::duration> loads;
+  for (auto& shard : m_shards) {
+    Clock::duration load{0};
+    for (const auto& world : shard->worlds) {
+      load += world.busy;
+    }
+    loads.push_back(load);
+  }
+
+  // Greedily move the largest world that still narrows the gap between the
+  // busiest and least busy shard.
+  while (true) {
+    const auto busiest = static_cast<std::size_t>(
+        std::max_element(loads.begin(), loads.end()) - loads.begin());
+    const auto quietest = static_cast<std::size_t>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    const auto gap = loads[busiest] - loads[quietest];
+
+    auto& from = m_shards[busiest]->worlds;
+    auto candidate = from.end();
+    for (auto world = from.begin(); world != from.end(); ++world) {
+      // A world mid-tick stays where it is.
+      if (world->handle == m_shards[busiest]->ticking) {
+        continue;
+      }
+      if (world->busy > Clock::duration{0} && world->busy < gap &&
+          (candidate == from.end() || world->busy > candidate->busy)) {
+        candidate = world;
+      }
+    }
+    if (candidate == from.end()) {
+      break;
+    }
+
+    loads[busiest] -= candidate->busy;
+    loads[quietest] += candidate->busy;
+    m_worldShards[candidate->handle] = quietest;
+    m_shards[quietest]->worlds.push_back(std::move(*candidate));
+    from.erase(candidate);
+    ++m_shards[busiest]->worldsVersion;
+    ++m_shards[quietest]->worldsVersion;
+  }
+
+  const auto now = Clock::now();
+  for (auto& shard : m_shards) {
+    shard->windowStart = now;
+    shard->busy = Clock::duration{0};
+    shard->ticks = 0;
+    for (auto& world : shard->worlds) {
+      world.busy = Clock::duration{0};
+    }
+  }
+
+  shardLocks.clear();
+  for (auto& shard : m_shards) {
+    shard->wake.notify_one();
+  }
+}
+
+void WorldRunner::RunShard(std::size_t index) {
+  if (m_pinShards) {
+    PinShard(index);
+  }
+
+  auto& shard = *m_shards[index];
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  while (!shard.stopping) {
+    auto nextDue = Clock::time_point::max();
+
+    for (std::size_t i = 0; i < shard.worlds.size() && !shard.stopping; ++i) {
+      auto* world = &shard.worlds[i];
+      const auto start = Clock::now();
+      if (world->nextTick > start) {
+        nextDue = std::min(nextDue, world->nextTick);
+        continue;
+      }
+
+      // Ticked without the lock. Removing or migrating this world waits for
+      // the tick, anything else may change the worlds meanwhile.
+      const auto handle = world->handle;
+      const auto context = world->context;
+      const auto deltaTime = world->deltaTime;
+      const auto version = shard.worldsVersion;
+      shard.ticking = handle;
+      lock.unlock();
+
+      std::exception_ptr error;
+      try {
+        context->Tick(deltaTime);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      const auto busy = Clock::now() - start;
+
+      lock.lock();
+      shard.ticking = 0;
+      shard.tickDone.notify_all();
+      world = &*FindWorld(shard, handle);
+
+      world->busy += busy;
+      shard.busy += busy;
+      ++world->ticks;
+      ++shard.ticks;
+
+      // Skip missed ticks rather than running them back to back.
+      world->nextTick += world->interval;
+      if (world->nextTick <= start) {
+        world->nextTick = start + world->interval;
+      }
+      nextDue = std::min(nextDue, world->nextTick);
+
+      if (error) {
+        // Reported once the tick is finished and without the lock, so the
+        // handler may call back into the runner, even to remove this world.
+        lock.unlock();
+        ReportError(handle, error);
+        lock.lock();
+      }
+
+      if (shard.worldsVersion != version) {
+        // Rescan, the worlds already ticked this pass are no longer due.
+        i = static_cast<std::size_t>(-1);
+        nextDue = Clock::time_point::max();
+      }
+    }
+
+    if (shard.stopping) {
+      break;
+    }
+
+    if (nextDue == Clock::time_point::max()) {
+      shard.wake.wait(lock);
+    } else {
+      shard.wake.wait_until(lock, nextDue);
+    }
+  }
+}
+
+void WorldRunner::ReportError(WorldHandle handle,
+                              std::exception_ptr error) const {
+  if (m_errorHandler) {
+    m_errorHandler(handle, error);
+    return;
+  }
+
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::exception& exception) {
+    std::cerr << "World " << handle << " failed to tick: " << exception.what()
+              << std::endl;
+  } catch (...) {
+    std::cerr << "World " << handle << " failed to tick" << std::endl;
+  }
+}
+
+void WorldRunner::PinShard(std::size_t index) {
+  const auto cores = std::max(1u, std::thread::hardware_concurrency());
+  const auto core = index % cores;
+
+  // Best effort, a shard that can't be pinned still runs.
+#if defined(__linux__)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core, &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#elif defined(_WIN32)
+  SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << core);
+#else
+  static_cast<void>(core);
+#endif
+}
+
+void WorldRunner::WaitForTick(Shard& shard, std::unique_lock<std::mutex>& lock,
+                              WorldHandle handle) {
+  shard.tickDone.wait(lock, [&shard, handle]() {
+    return shard.ticking != handle;
+  });
+}
+
+std::vector<WorldRunner::World>::iterator WorldRunner::FindWorld(
+    Shard& shard, WorldHandle handle) {
+  auto world = std::find_if(
+      shard.worlds.begin(), shard.worlds.end(),
+      [handle](const World& candidate) { return candidate.handle == handle; });
+  assert(world != shard.worlds.end());
+  return world;
+}
+
+WorldRunner::Shard& WorldRunner::GetShard(WorldHandle handle) const {
+  const auto worldShard = m_worldShards.find(handle);
+  if (worldShard == m_worldShards.end()) {
+    throw std::runtime_error("No world with handle " + std::to_string(handle));
+  }
+  return *m_shards[worldShard->second];
+}
@@ -22,6 +22,13 @@ class BoundDependency3 {
 
 class UnboundDependency {};
 
+class BoundDependencyHolder {
+ public:
+  BoundDependencyHolder(std::shared_ptr<BoundDependency1> a) : dependency{a} {}
+
+  std::shared_ptr<BoundDependency1> dependency;
+};
+
 ///
 /// Test Models
 ///
@@ -146,3 +153,84 @@ class AnotherTestUpdatable : public IUpdatable<AnotherTestUpdatable> {
 };
 
 class SharedSignalTestModel : public BaseTestModel {};
+
+class RateLimitedUpdatable : public IUpdatable<RateLimitedUpdatable> {
+ public:
+  void Update(double deltaTime) {
+    ++updateCount;
+    totalTime += deltaTime;
+  }
+
+  int updateCount = 0;
+  double totalTime = 0.0;
+};
+
+class ThrowingUpdatable : public IUpdatable<ThrowingUpdatable> {
+ public:
+  void Update(double deltaTime) { throw std::runtime_error("update failed"); }
+};
+
+class AnotherRateLimitedUpdatable
+    : public IUpdatable<AnotherRateLimitedUpdatable> {
+ public:
+  void Update(double deltaTime) {
+    ++updateCount;
+    totalTime += deltaTime;
+  }
+
+  int updateCount = 0;
+  double totalTime = 0.0;
+};
+
+struct KeyPressedEvent {
+  int key;
+};
+
+struct MouseMovedEvent {
+  int x;
+  int y;
+};
+
+struct KeyedTestComponent {
+  int value;
+};
+
+// Allocated through the align_val_t operator new.
+struct alignas(64) OverAlignedTestModel {
+  int value{0};
+};
+
+// Kept consistent by the writer, so a torn read shows up.
+class FrameModel {
+ public:
+  int frame{0};
+  int doubled{0};
+};
+
+class EventHandlingUpdatable : public IUpdatable<EventHandlingUpdatable> {
+ public:
+  void OnEvents(EventSpan<KeyPressedEvent> events) {
+    ++batchCount;
+    for (const auto& event : events) {
+      keys.push_back(event.key);
+    }
+  }
+
+  int batchCount = 0;
+  std::vector<int> keys;
+};
+
+class PhaseRecordingUpdatable : public IUpdatable<PhaseRecordingUpdatable> {
+ public:
+  PhaseRecordingUpdatable(std::shared_ptr<std::vector<std::string>> log,
+                          std::string name)
+      : m_log{log}, m_name{name} {}
+
+  void PreUpdate() { m_log->push_back(m_name + " pre"); }
+  void Update(double deltaTime) { m_log->push_back(m_name + " update"); }
+  void PostUpdate() { m_log->push_back(m_name + " post"); }
+
+ private:
+  std::shared_ptr<std::vector<std::string>> m_log;
+  std::string m_name;
+};
@@ -173,3 +173,50 @@ class SharedSignalCommand : public CommandBase {
  private:
   std::shared_ptr<SharedSignalTestModel> m_pSharedSignalTestModel;
 };
+
+class StaticPhraseCommand {
+ public:
+  StaticPhraseCommand(std::shared_ptr<SingletonTestModel> model)
+      : _model(model) {}
+
+  void Execute(const std::string& first, const std::string& second) {
+    _model->phrase = first + second;
+  }
+
+ private:
+  std::shared_ptr<SingletonTestModel> _model;
+};
+
+class StaticRecordingCommand {
+ public:
+  StaticRecordingCommand(std::shared_ptr<SingletonTestModel> model)
+      : _model(model) {}
+
+  void Execute(const std::string&, const std::string&) {
+    seenPhrases.push_back(_model->phrase);
+  }
+
+  std::vector<std::string> seenPhrases;
+
+ private:
+  std::shared_ptr<SingletonTestModel> _model;
+};
+
+class StaticPhraseSignal
+    : public StaticSignal<
+          command_chain<creator<StaticPhraseCommand, SingletonTestModel>,
+                        creator<StaticRecordingCommand, SingletonTestModel>>,
+          std::string, std::string> {};
+
+class BorrowingCommand : public CommandBase {
+ public:
+  BorrowingCommand(Borrowed<SingletonTestModel> model) : _model(model) {}
+
+  void Execute(std::shared_ptr<SignalBase> signal) override {
+    _model->phrase = "borrowed";
+    Release();
+  }
+
+ private:
+  Borrowed<SingletonTestModel> _model;
+};
@@ -1,5 +1,9 @@
 #pragma once
 #include <culprit-framework/CulpritFramework.h>
+#include <culprit-framework/StaticContext.hpp>
+
+#include <chrono>
+#include <thread>
 
 #include "CommandDefinitions.h"
 #include "SignalDefinitions.h"
@@ -123,3 +127,204 @@ class ParentSharedSignalContext : public ContextBase {
         .Do<RemoveContextCommand<ChildSharedSignalContext>, ContextBase>();
   }
 };
+
+class MetricsContext : public ContextBase {
+  void SetBindings() override {
+    Bind<BaseTestModel>().To<BaseTestModel>();
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+
+    On<TestSignal2>()
+        .Do<TestCommand, SingletonTestModel>()
+        .Do<AnotherTestCommand, SingletonTestModel>();
+  }
+};
+
+class SignalDispatchingUpdatable
+    : public IUpdatable<SignalDispatchingUpdatable> {
+ public:
+  SignalDispatchingUpdatable(std::shared_ptr<TestSignal2> signal,
+                             std::shared_ptr<SingletonTestModel> model)
+      : m_signal{signal}, m_model{model} {}
+
+  void Update(double deltaTime) {
+    m_signal->Dispatch();
+    phraseAfterDispatch = m_model->phrase;
+  }
+
+  std::string phraseAfterDispatch;
+
+ private:
+  std::shared_ptr<TestSignal2> m_signal;
+  std::shared_ptr<SingletonTestModel> m_model;
+};
+
+class IsolatedChildContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SignalDispatchingUpdatable>()
+        .To<SignalDispatchingUpdatable, TestSignal2, SingletonTestModel>();
+  }
+};
+
+class AnotherIsolatedChildContext : public ContextBase {
+  void SetBindings() override {}
+};
+
+class SessionContext : public ContextBase {
+ public:
+  int recycleCount = 0;
+
+ protected:
+  void OnRecycle() override { ++recycleCount; }
+
+ private:
+  void SetBindings() override {
+    Bind<TimeModel>().ToSingleton<TimeModel>();
+
+    On<TestSignal2>().Do<AnotherTestCommand, SingletonTestModel>();
+  }
+};
+
+class TemplatedSessionContext : public ContextBase {
+ public:
+  static inline int setBindingsCalls = 0;
+
+ protected:
+  bool UsesBindingTemplate() const override { return true; }
+
+ private:
+  void SetBindings() override {
+    ++setBindingsCalls;
+
+    Bind<TimeModel>().ToSingleton<TimeModel>();
+    Bind<TestModelChild>().To<TestModelChild>();
+
+    On<TestSignal1>().Do<TestCommand, SingletonTestModel>();
+    On<TestSignal2>().Do<AnotherTestCommand, SingletonTestModel>();
+  }
+};
+
+class BrokenSingletonContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SignalDispatchingUpdatable>()
+        .ToSingleton<SignalDispatchingUpdatable, TestSignal2,
+                     SingletonTestModel>();
+  }
+};
+
+class BackgroundReclaimContext : public ContextBase {
+  std::unique_ptr<Reclaimer> CreateReclaimer() const override {
+    return std::make_unique<Reclaimer>(Reclaimer::Mode::Background);
+  }
+
+  void SetBindings() override {
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+  }
+};
+
+// Takes a while to tear down, so retirements are still pending at exit.
+class SlowTeardownContext : public ContextBase {
+ public:
+  ~SlowTeardownContext() override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+ private:
+  void SetBindings() override {}
+};
+
+class StaticParentContext : public ContextBase {
+  void SetBindings() override {
+    Bind<BoundDependency2>().ToSingleton<BoundDependency2>();
+  }
+};
+
+class ShadowedParentContext : public ContextBase {
+  void SetBindings() override {
+    Bind<BoundDependency1>().ToSingleton<BoundDependency1>();
+    Bind<BoundDependency2>().ToSingleton<BoundDependency2>();
+  }
+};
+
+class StaticHotContext
+    : public StaticContext<
+          bind_singleton<BoundDependency1, creator<BoundDependency1>>,
+          bind_to<BaseTestModel, creator<TestModelWith2Dependency,
+                                         BoundDependency1, BoundDependency2>>> {
+  void SetRuntimeBindings() override {
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+  }
+};
+
+class RecyclingStaticContext
+    : public StaticContext<
+          bind_singleton<BoundDependency1, creator<BoundDependency1>>> {
+  void SetRuntimeBindings() override {
+    Bind<BoundDependencyHolder>()
+        .ToSingleton<BoundDependencyHolder, BoundDependency1>();
+  }
+};
+
+class RuntimeChildContext : public ContextBase {
+  void SetBindings() override {}
+};
+
+class StaticSignalContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+    BindSignal<StaticPhraseSignal>();
+  }
+};
+
+class ConcurrentResolveContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+    Bind<BoundDependency1>().ToSingleton<BoundDependency1>();
+    Bind<TestModelWith1Dependency>()
+        .To<TestModelWith1Dependency, BoundDependency1>();
+  }
+};
+
+class BorrowingContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SingletonTestModel>().ToSingleton<SingletonTestModel>();
+    Bind<BaseTestModel>().To<BaseTestModel>();
+
+    On<TestSignal1>().Do<BorrowingCommand, borrow<SingletonTestModel>>();
+  }
+};
+
+class SnapshotContext : public ContextBase {
+  void SetBindings() override {
+    Bind<TimeModel>().ToSnapshotted<TimeModel>();
+    Bind<FrameModel>().ToSnapshotted<FrameModel>();
+    Bind<TestUpdatable>().To<TestUpdatable, TimeModel>();
+
+    On<EnterContextSignal>()
+        .Do<AddTestUpdatableCommand, ContextBase, TestUpdatable>();
+  }
+};
+
+// Removes its ParentContext's ChildContext sibling from its first update.
+class SiblingRemovingUpdatable : public IUpdatable<SiblingRemovingUpdatable> {
+ public:
+  SiblingRemovingUpdatable(std::shared_ptr<TestRemoveChildContextSignal> signal)
+      : m_signal{signal} {}
+
+  void Update(double deltaTime) {
+    if (!m_dispatched) {
+      m_dispatched = true;
+      m_signal->Dispatch();
+    }
+  }
+
+ private:
+  std::shared_ptr<TestRemoveChildContextSignal> m_signal;
+  bool m_dispatched{false};
+};
+
+class SiblingRemovingContext : public ContextBase {
+  void SetBindings() override {
+    Bind<SiblingRemovingUpdatable>()
+        .To<SiblingRemovingUpdatable, TestRemoveChildContextSignal>();
+  }
+};
@@ -1,13 +1,34 @@
 #include <culprit-framework/CulpritFramework.h>
-
+#include <culprit-framework/WorldRunner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <new>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 #include "ClassDefinitions.h"
 #include "ContextDefinitions.h"
 #include "SignalDefinitions.h"
 #include "gtest/gtest.h"
 
+// Fails if the statement allocates on the calling thread. Only meaningful
+// when built with CULPRIT_TRACK_ALLOCATIONS.
+#define EXPECT_NO_ALLOCATIONS(...)                                       \
+  do {                                                                   \
+    const auto allocationsBefore = AllocationTracker::GetThreadCount();  \
+    __VA_ARGS__;                                                         \
+    EXPECT_EQ(allocationsBefore, AllocationTracker::GetThreadCount())    \
+        << "Allocated in: " #__VA_ARGS__;                                \
+  } while (false)
+
 TEST(Resolving, CanResolveBoundObject) {
   auto context = std::make_shared<BasicContext>();
   context->Initialise();
@@ -373,6 +394,28 @@ TEST(SignalAttachDetach, DifferentInstancesOfSameClass) {
   ASSERT_EQ("0123123123", anotherClassToNotify.functionHistory);
 }
 
+TEST(SignalAttachDetach, ThrowingObserverLeavesTheSignalUsable) {
+  auto context = std::make_shared<SignalForAttachDetachContext>();
+  context->Initialise();
+  context->Enter();
+
+  AttachToSignalClass classToNotify;
+  auto signal = context->Resolve<SignalForAttach>();
+  ThrowingObserver throwing(*signal, classToNotify);
+  const auto attachToken =
+      signal->Attach<ThrowingObserver>(&throwing, &ThrowingObserver::function);
+
+  ASSERT_THROW(signal->Dispatch(), std::runtime_error);
+  ASSERT_EQ("0", classToNotify.functionHistory);
+
+  // The attach made before the throw, and the ones after, all take effect.
+  signal->Detach(attachToken);
+  signal->Attach<AttachToSignalClass>(&classToNotify,
+                                      &AttachToSignalClass::function2);
+  signal->Dispatch();
+  ASSERT_EQ("012", classToNotify.functionHistory);
+}
+
 TEST(ChildContexts, EnterAndExitContextSignals) {
   std::shared_ptr<SingletonTestModel> singletonTestModel;
 
@@ -607,3 +650,1653 @@ TEST(SharedSignals, BoundSignalExecuteInParentAndChildCommandChain) {
   ASSERT_TRUE(testModel->phrase.find("I got called in child context") !=
               std::string::npos);
 }
+
+TEST(Updating, FrameDivisorUpdatableReceivesAccumulatedTime) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto updatable = std::make_shared<RateLimitedUpdatable>();
+  context->AddUpdatable<RateLimitedUpdatable>(updatable,
+                                              UpdateRate::EveryNthFrame(4));
+
+  for (int frame = 0; frame < 8; ++frame) {
+    context->PreUpdate();
+    context->Update(0.25);
+    context->PostUpdate();
+  }
+
+  ASSERT_EQ(2, updatable->updateCount);
+  ASSERT_DOUBLE_EQ(2.0, updatable->totalTime);
+}
+
+TEST(Updating, ReducedRateUpdatablesAreSpreadAcrossFrames) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto first = std::make_shared<RateLimitedUpdatable>();
+  auto second = std::make_shared<AnotherRateLimitedUpdatable>();
+  context->AddUpdatable<RateLimitedUpdatable>(first,
+                                              UpdateRate::EveryNthFrame(2));
+  context->AddUpdatable<AnotherRateLimitedUpdatable>(
+      second, UpdateRate::EveryNthFrame(2));
+
+  for (int frame = 0; frame < 4; ++frame) {
+    context->PreUpdate();
+    context->Update(0.5);
+    context->PostUpdate();
+
+    // exactly one of the pair runs on any given frame
+    ASSERT_EQ(frame + 1, first->updateCount + second->updateCount);
+  }
+}
+
+TEST(Updating, FrequencyUpdatableKeepsItsRate) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto updatable = std::make_shared<RateLimitedUpdatable>();
+  context->AddUpdatable<RateLimitedUpdatable>(updatable,
+                                              UpdateRate::AtFrequency(10.0));
+
+  for (int frame = 0; frame < 100; ++frame) {
+    context->PreUpdate();
+    context->Update(0.01);
+    context->PostUpdate();
+  }
+
+  // 1 second at 10Hz, no time is lost between ticks
+  ASSERT_NEAR(10, updatable->updateCount, 1);
+  ASSERT_GT(updatable->totalTime, 0.9);
+  ASSERT_LE(updatable->totalTime, 1.0 + 1e-9);
+}
+
+TEST(FrameScheduling, DeferredWorkRunsBetweenUpdateAndPostUpdate) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  bool jobRan = false;
+  auto scheduler = context->Resolve<FrameScheduler>();
+  scheduler->Schedule([&jobRan]() { jobRan = true; });
+
+  context->PreUpdate();
+  context->Update(0.016);
+  ASSERT_FALSE(jobRan);
+
+  context->PostUpdate();
+  ASSERT_TRUE(jobRan);
+  ASSERT_EQ(1u, scheduler->GetLastFrameReport().jobsRun);
+  ASSERT_EQ(0u, scheduler->GetLastFrameReport().jobsPending);
+}
+
+TEST(FrameScheduling, WorkOverBudgetCarriesToNextFrame) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  int jobsRun = 0;
+  auto scheduler = context->Resolve<FrameScheduler>();
+  scheduler->SetFrameBudget(std::chrono::microseconds{0});
+  for (int i = 0; i < 3; ++i) {
+    scheduler->Schedule([&jobsRun]() { ++jobsRun; });
+  }
+
+  for (int frame = 1; frame <= 3; ++frame) {
+    context->PreUpdate();
+    context->Update(0.016);
+    context->PostUpdate();
+
+    // a zero budget still makes progress, one job at a time
+    ASSERT_EQ(frame, jobsRun);
+    ASSERT_EQ(1u, scheduler->GetLastFrameReport().jobsRun);
+    ASSERT_EQ(static_cast<size_t>(3 - frame),
+              scheduler->GetLastFrameReport().jobsPending);
+  }
+}
+
+TEST(FrameScheduling, ChildContextsShareTheRootScheduler) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto childContext = context->AddChildContext<ChildContext>();
+  childContext->Enter();
+
+  ASSERT_EQ(context->Resolve<FrameScheduler>().get(),
+            childContext->Resolve<FrameScheduler>().get());
+
+  int jobsRun = 0;
+  childContext->Resolve<FrameScheduler>()->Schedule(
+      [&jobsRun]() { ++jobsRun; });
+
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+
+  // run once by the root, not again by the child
+  ASSERT_EQ(1, jobsRun);
+}
+
+TEST(Profiling, ScopesExportAsChromeTrace) {
+  Profiler::Clear();
+  {
+    ProfileScope scope("Test", "ProfiledScope", 3);
+  }
+  ASSERT_GE(Profiler::GetRecordedCount(), 1u);
+
+  const std::string path = "culprit_profiler_test_trace.json";
+  ASSERT_TRUE(Profiler::WriteChromeTrace(path));
+
+  std::ifstream file(path);
+  const std::string trace((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  file.close();
+  std::remove(path.c_str());
+
+  ASSERT_NE(std::string::npos, trace.find("\"traceEvents\""));
+  ASSERT_NE(std::string::npos, trace.find("\"name\":\"ProfiledScope\""));
+  ASSERT_NE(std::string::npos, trace.find("\"args\":{\"value\":3}"));
+  Profiler::Clear();
+}
+
+#if defined(CULPRIT_ENABLE_PROFILING)
+TEST(Profiling, FrameworkPhasesAreRecorded) {
+  auto context = std::make_shared<SignalsWithCommandsContext>();
+  context->Initialise();
+  context->Enter();
+
+  Profiler::Clear();
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+  // lifecycle signals of the three phases plus the phases themselves
+  ASSERT_GE(Profiler::GetRecordedCount(), 6u);
+
+  Profiler::Clear();
+  context->Resolve<TestSignal2>()->Dispatch();
+  // the dispatch and both commands in the chain
+  ASSERT_EQ(3u, Profiler::GetRecordedCount());
+  Profiler::Clear();
+}
+#endif
+
+TEST(Metrics, ResolvesAreSplitBySingletonAndTransient) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  const auto before = context->SnapshotMetrics();
+  context->Resolve<SingletonTestModel>();
+  context->Resolve<SingletonTestModel>();
+  context->Resolve<BaseTestModel>();
+  const auto after = context->SnapshotMetrics();
+
+  ASSERT_EQ(2u, after.singletonResolves - before.singletonResolves);
+  ASSERT_EQ(1u, after.transientResolves - before.transientResolves);
+  ASSERT_GE(after.TransientResolvesPerSecond(before), 0.0);
+}
+
+TEST(Metrics, DispatchesAndCommandChainsAreCounted) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto signal = context->Resolve<TestSignal2>();
+  signal->Dispatch();
+  signal->Dispatch();
+
+  const auto snapshot = context->SnapshotMetrics();
+  auto signalMetrics = std::find_if(
+      snapshot.signals.begin(), snapshot.signals.end(),
+      [](const SignalMetrics& metrics) {
+        return std::string(typeid(TestSignal2).name()) == metrics.name;
+      });
+  ASSERT_NE(snapshot.signals.end(), signalMetrics);
+  ASSERT_EQ(2u, signalMetrics->dispatches);
+
+  // both dispatches ran the two command chain to completion
+  ASSERT_EQ(4u, snapshot.commandsExecuted);
+  ASSERT_EQ(0u, snapshot.pendingCommandChains);
+}
+
+TEST(ChildContexts, UpdatableCanRemoveASiblingMidUpdate) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto remover = context->AddChildContext<SiblingRemovingContext>();
+  remover->AddUpdatable(remover->Resolve<SiblingRemovingUpdatable>());
+  context->AddChildContext<ChildContext>();
+  auto last = context->AddChildContext<BasicUpdatableContext>();
+  last->Enter();
+
+  context->Update(0.5);
+  ASSERT_EQ(nullptr, context->TryGetChildContext<ChildContext>());
+  // The child after the removed one still updated this frame.
+  ASSERT_EQ(0.5, last->Resolve<TimeModel>()->totalTime);
+
+  context->Update(0.5);
+  ASSERT_EQ(1.0, last->Resolve<TimeModel>()->totalTime);
+  ASSERT_EQ(2u, context->SnapshotMetrics().contexts.size() - 1);
+}
+
+TEST(ChildContexts, RemovingASiblingMidTickSkipsItsChildren) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto remover = context->AddChildContext<SiblingRemovingContext>();
+  remover->AddUpdatable(remover->Resolve<SiblingRemovingUpdatable>());
+  auto removed = context->AddChildContext<ChildContext>();
+  auto grandchild = removed->AddChildContext<BasicUpdatableContext>();
+  grandchild->Enter();
+  auto timeModel = grandchild->Resolve<TimeModel>();
+
+  context->Tick(0.5);
+  ASSERT_EQ(nullptr, context->TryGetChildContext<ChildContext>());
+  // The removed sibling's child exited with it, so it doesn't update.
+  ASSERT_EQ(0.0, timeModel->totalTime);
+}
+
+TEST(Metrics, SnapshotAggregatesChildContextsAndStores) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  context->AddChildContext<ChildContext>()->Enter();
+  context->Store<BaseTestModel>(std::make_shared<BaseTestModel>());
+
+  auto snapshot = context->SnapshotMetrics();
+  ASSERT_EQ(2u, snapshot.contexts.size());
+  ASSERT_EQ(1u, snapshot.contexts[1].depth);
+  ASSERT_EQ(1u, snapshot.childContextsCreated);
+  ASSERT_EQ(static_cast<std::int64_t>(sizeof(BaseTestModel)),
+            snapshot.storedBytes);
+
+  context->RemoveChildContext<ChildContext>();
+  context->DeleteFromStore<BaseTestModel>();
+  context->PreUpdate();
+
+  snapshot = context->SnapshotMetrics();
+  ASSERT_EQ(1u, snapshot.contexts.size());
+  ASSERT_EQ(1u, snapshot.childContextsDestroyed);
+  ASSERT_EQ(0, snapshot.storedBytes);
+}
+
+TEST(Updating, InactiveUpdatableKeepsItsSlot) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto first = std::make_shared<RateLimitedUpdatable>();
+  auto second = std::make_shared<AnotherRateLimitedUpdatable>();
+  context->AddUpdatable<RateLimitedUpdatable>(first);
+  context->AddUpdatable<AnotherRateLimitedUpdatable>(second);
+  const auto order = context->GetUpdatableOrder<RateLimitedUpdatable>();
+
+  context->SetUpdatableActive<RateLimitedUpdatable>(false);
+  ASSERT_FALSE(context->IsUpdatableActive<RateLimitedUpdatable>());
+
+  context->PreUpdate();
+  context->Update(0.5);
+  context->PostUpdate();
+  ASSERT_EQ(0, first->updateCount);
+  ASSERT_EQ(1, second->updateCount);
+
+  context->SetUpdatableActive<RateLimitedUpdatable>(true);
+  context->PreUpdate();
+  context->Update(0.5);
+  context->PostUpdate();
+  ASSERT_EQ(1, first->updateCount);
+  ASSERT_EQ(order, context->GetUpdatableOrder<RateLimitedUpdatable>());
+}
+
+TEST(ChildContexts, InactiveChildContextIsSkipped) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto childContext = context->AddChildContext<ChildContext>();
+  childContext->Enter();
+  auto updatable = std::make_shared<RateLimitedUpdatable>();
+  childContext->AddUpdatable<RateLimitedUpdatable>(updatable);
+
+  childContext->SetActive(false);
+  for (int frame = 0; frame < 3; ++frame) {
+    context->PreUpdate();
+    context->Update(0.5);
+    context->PostUpdate();
+  }
+  ASSERT_EQ(0, updatable->updateCount);
+
+  childContext->SetActive(true);
+  context->PreUpdate();
+  context->Update(0.5);
+  context->PostUpdate();
+  ASSERT_EQ(1, updatable->updateCount);
+  ASSERT_DOUBLE_EQ(0.5, updatable->totalTime);
+}
+
+TEST(EventRouting, OnlySubscribedHandlersReceiveEvents) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto updatable = std::make_shared<EventHandlingUpdatable>();
+  context->AddUpdatable<EventHandlingUpdatable>(updatable);
+  context->SubscribeEvents<KeyPressedEvent, EventHandlingUpdatable>();
+
+  int mouseBatches = 0;
+  context->SubscribeEvents<MouseMovedEvent>(
+      [&mouseBatches](EventSpan<MouseMovedEvent> events) { ++mouseBatches; });
+
+  std::vector<KeyPressedEvent> keys{{1}, {2}, {3}};
+  context->HandleEvents<KeyPressedEvent>(keys);
+
+  // one call for the whole batch, and no mouse handler was involved
+  ASSERT_EQ(1, updatable->batchCount);
+  ASSERT_EQ((std::vector<int>{1, 2, 3}), updatable->keys);
+  ASSERT_EQ(0, mouseBatches);
+
+  context->HandleEvent(MouseMovedEvent{4, 2});
+  ASSERT_EQ(1, mouseBatches);
+  ASSERT_EQ(1, updatable->batchCount);
+}
+
+TEST(EventRouting, RoutesFollowChildContextsAndSubscriptions) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  int parentEvents = 0;
+  const auto token = context->SubscribeEvents<KeyPressedEvent>(
+      [&parentEvents](EventSpan<KeyPressedEvent> events) {
+        parentEvents += static_cast<int>(events.size());
+      });
+  context->HandleEvent(KeyPressedEvent{1});
+  ASSERT_EQ(1, parentEvents);
+
+  // a child added after the route was cached still gets events
+  auto childContext = context->AddChildContext<ChildContext>();
+  childContext->Enter();
+  auto updatable = std::make_shared<EventHandlingUpdatable>();
+  childContext->AddUpdatable<EventHandlingUpdatable>(updatable);
+  childContext->SubscribeEvents<KeyPressedEvent, EventHandlingUpdatable>();
+
+  context->HandleEvent(KeyPressedEvent{2});
+  ASSERT_EQ(2, parentEvents);
+  ASSERT_EQ((std::vector<int>{2}), updatable->keys);
+
+  childContext->SetActive(false);
+  context->UnsubscribeEvents(token);
+  context->HandleEvent(KeyPressedEvent{3});
+  ASSERT_EQ(2, parentEvents);
+  ASSERT_EQ((std::vector<int>{2}), updatable->keys);
+
+  childContext->SetActive(true);
+  childContext->RemoveUpdatable<EventHandlingUpdatable>();
+  context->PreUpdate();
+  context->HandleEvent(KeyPressedEvent{4});
+  ASSERT_EQ((std::vector<int>{2}), updatable->keys);
+}
+
+TEST(Ticking, TickKeepsPhaseOrderingAcrossTheTree) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto childContext = context->AddChildContext<ChildContext>();
+  childContext->Enter();
+
+  auto log = std::make_shared<std::vector<std::string>>();
+  context->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "parent"));
+  childContext->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "child"));
+
+  context->Tick(0.016);
+
+  ASSERT_EQ((std::vector<std::string>{"parent pre", "child pre",
+                                      "parent update", "child update",
+                                      "parent post", "child post"}),
+            *log);
+}
+
+TEST(Ticking, TickFollowsChangesToTheTree) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto log = std::make_shared<std::vector<std::string>>();
+  context->Tick(0.016);
+  ASSERT_TRUE(log->empty());
+
+  auto childContext = context->AddChildContext<ChildContext>();
+  childContext->Enter();
+  childContext->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "child"));
+
+  context->Tick(0.016);
+  ASSERT_EQ(3u, log->size());
+
+  childContext->SetActive(false);
+  context->Tick(0.016);
+  ASSERT_EQ(3u, log->size());
+
+  childContext->SetActive(true);
+  context->RemoveChildContext<ChildContext>();
+  context->Tick(0.016);
+  ASSERT_EQ(3u, log->size());
+}
+
+TEST(Ticking, TickProcessesDeferredStoreDeletes) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  context->Store<BaseTestModel>(std::make_shared<BaseTestModel>());
+  context->DeleteFromStore<BaseTestModel>();
+  ASSERT_TRUE(context->HasStored<BaseTestModel>());
+
+  context->Tick(0.016);
+  ASSERT_FALSE(context->HasStored<BaseTestModel>());
+}
+
+TEST(ParallelUpdate, IsolatedChildrenRunAfterTheirSiblings) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+  context->SetWorkerPool(std::make_shared<WorkStealingPool>(2));
+
+  auto isolatedContext = context->AddChildContext<IsolatedChildContext>();
+  isolatedContext->SetIsolated(true);
+  auto childContext = context->AddChildContext<ChildContext>();
+
+  // Only one isolated child, so the log is never written concurrently.
+  auto log = std::make_shared<std::vector<std::string>>();
+  context->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "parent"));
+  isolatedContext->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "isolated"));
+  childContext->AddUpdatable<PhaseRecordingUpdatable>(
+      std::make_shared<PhaseRecordingUpdatable>(log, "child"));
+
+  const std::vector<std::string> expected{
+      "parent pre",    "child pre",    "isolated pre",
+      "parent update", "child update", "isolated update",
+      "parent post",   "child post",   "isolated post"};
+
+  context->Tick(0.016);
+  ASSERT_EQ(expected, *log);
+
+  log->clear();
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+  ASSERT_EQ(expected, *log);
+}
+
+TEST(ParallelUpdate, IsolatedSiblingsAllUpdate) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+  context->SetWorkerPool(std::make_shared<WorkStealingPool>(2));
+
+  auto first = context->AddChildContext<IsolatedChildContext>();
+  auto second = context->AddChildContext<AnotherIsolatedChildContext>();
+  first->SetIsolated(true);
+  second->SetIsolated(true);
+
+  auto firstUpdatable = std::make_shared<RateLimitedUpdatable>();
+  auto secondUpdatable = std::make_shared<RateLimitedUpdatable>();
+  first->AddUpdatable<RateLimitedUpdatable>(firstUpdatable);
+  second->AddUpdatable<RateLimitedUpdatable>(secondUpdatable);
+
+  for (int i = 0; i < 50; ++i) {
+    context->Tick(0.01);
+  }
+  context->Update(0.01);
+
+  ASSERT_EQ(51, firstUpdatable->updateCount);
+  ASSERT_EQ(51, secondUpdatable->updateCount);
+
+  // Without a pool they still update, one after the other.
+  context->SetWorkerPool(nullptr);
+  context->Tick(0.01);
+  ASSERT_EQ(52, firstUpdatable->updateCount);
+  ASSERT_EQ(52, secondUpdatable->updateCount);
+}
+
+TEST(ParallelUpdate, SignalsOwnedOutsideAreQueuedUntilTheSyncPoint) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+  context->SetWorkerPool(std::make_shared<WorkStealingPool>(2));
+
+  auto isolatedContext = context->AddChildContext<IsolatedChildContext>();
+  isolatedContext->SetIsolated(true);
+  auto updatable = isolatedContext->Resolve<SignalDispatchingUpdatable>();
+  isolatedContext->AddUpdatable<SignalDispatchingUpdatable>(updatable);
+
+  context->Tick(0.016);
+
+  // The parent's command chain ran once the isolated update had finished.
+  ASSERT_EQ("default", updatable->phraseAfterDispatch);
+  ASSERT_EQ("changed twice", context->Resolve<SingletonTestModel>()->phrase);
+  ASSERT_EQ(1u, context->Resolve<TestSignal2>()->GetDispatchCount());
+}
+
+TEST(WorldRunning, WorldsTickAtTheirOwnRates) {
+  WorldRunner runner(2);
+
+  auto fastWorld = std::make_shared<BasicContext>();
+  fastWorld->Initialise();
+  fastWorld->Enter();
+  auto fastUpdatable = std::make_shared<RateLimitedUpdatable>();
+  fastWorld->AddUpdatable<RateLimitedUpdatable>(fastUpdatable);
+
+  auto slowWorld = std::make_shared<BasicContext>();
+  slowWorld->Initialise();
+  slowWorld->Enter();
+  auto slowUpdatable = std::make_shared<RateLimitedUpdatable>();
+  slowWorld->AddUpdatable<RateLimitedUpdatable>(slowUpdatable);
+
+  const auto fast = runner.AddWorld(fastWorld, 400.0);
+  const auto slow = runner.AddWorld(slowWorld, 25.0);
+  ASSERT_NE(runner.GetShardOf(fast), runner.GetShardOf(slow));
+
+  runner.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  runner.Stop();
+
+  ASSERT_GT(slowUpdatable->updateCount, 0);
+  ASSERT_GT(fastUpdatable->updateCount, slowUpdatable->updateCount);
+  ASSERT_EQ(static_cast<std::uint64_t>(fastUpdatable->updateCount),
+            runner.GetTickCount(fast));
+
+  // Fixed step of one tick at the world's rate.
+  ASSERT_NEAR(slowUpdatable->updateCount / 25.0, slowUpdatable->totalTime,
+              1e-9);
+}
+
+TEST(WorldRunning, MigratedWorldKeepsTicking) {
+  WorldRunner runner(2);
+
+  const auto world = runner.AddWorld<BasicContext>(200.0);
+  const auto original = runner.GetShardOf(world);
+  runner.MigrateWorld(world, 1 - original);
+  ASSERT_EQ(1 - original, runner.GetShardOf(world));
+
+  runner.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  runner.Stop();
+  ASSERT_GT(runner.GetTickCount(world), 0u);
+
+  const auto samples = runner.SampleUtilisation();
+  ASSERT_EQ(2u, samples.size());
+  ASSERT_EQ(0u, samples[original].worlds);
+  ASSERT_EQ(1u, samples[1 - original].worlds);
+  ASSERT_GT(samples[1 - original].ticks, 0u);
+  ASSERT_LE(samples[1 - original].utilisation, 1.0);
+
+  ASSERT_TRUE(runner.RemoveWorld(world));
+  ASSERT_FALSE(runner.RemoveWorld(world));
+}
+
+TEST(WorldRunning, RebalanceSpreadsBusyWorlds) {
+  WorldRunner runner(2);
+
+  std::vector<WorldRunner::WorldHandle> worlds;
+  for (int i = 0; i < 4; ++i) {
+    worlds.push_back(runner.AddWorld<BasicContext>(500.0));
+    runner.MigrateWorld(worlds.back(), 0);
+  }
+
+  runner.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  runner.Rebalance();
+  runner.Stop();
+
+  std::size_t onFirstShard = 0;
+  for (const auto world : worlds) {
+    onFirstShard += runner.GetShardOf(world) == 0 ? 1 : 0;
+  }
+  ASSERT_GT(onFirstShard, 0u);
+  ASSERT_LT(onFirstShard, worlds.size());
+}
+
+TEST(WorldRunning, ErrorHandlerCanRemoveTheFailingWorld) {
+  WorldRunner runner(1);
+  std::atomic<int> failures{0};
+  std::atomic<bool> removed{false};
+  std::atomic<std::uint64_t> healthyTicks{0};
+  WorldRunner::WorldHandle healthy = 0;
+  runner.SetErrorHandler(
+      [&](WorldRunner::WorldHandle handle, std::exception_ptr error) {
+        ++failures;
+        healthyTicks = runner.GetTickCount(healthy);
+        removed = runner.RemoveWorld(handle);
+      });
+
+  auto failingWorld = std::make_shared<BasicContext>();
+  failingWorld->Initialise();
+  failingWorld->Enter();
+  failingWorld->AddUpdatable<ThrowingUpdatable>(
+      std::make_shared<ThrowingUpdatable>());
+
+  healthy = runner.AddWorld<BasicContext>(200.0);
+  const auto failing = runner.AddWorld(failingWorld, 200.0);
+
+  runner.Start();
+  for (int i = 0; i < 1000 && !removed; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  runner.Stop();
+
+  ASSERT_TRUE(removed);
+  ASSERT_EQ(1, failures.load());
+  ASSERT_FALSE(runner.RemoveWorld(failing));
+  ASSERT_GT(runner.GetTickCount(healthy), healthyTicks.load());
+}
+
+TEST(WorldRunning, FailingWorldIsReportedAndTheShardCarriesOn) {
+  WorldRunner runner(1);
+  std::atomic<int> failures{0};
+  std::atomic<WorldRunner::WorldHandle> failedWorld{0};
+  runner.SetErrorHandler(
+      [&](WorldRunner::WorldHandle handle, std::exception_ptr error) {
+        failedWorld = handle;
+        ++failures;
+      });
+
+  auto failingWorld = std::make_shared<BasicContext>();
+  failingWorld->Initialise();
+  failingWorld->Enter();
+  failingWorld->AddUpdatable<ThrowingUpdatable>(
+      std::make_shared<ThrowingUpdatable>());
+
+  const auto failing = runner.AddWorld(failingWorld, 200.0);
+  const auto healthy = runner.AddWorld<BasicContext>(200.0);
+
+  runner.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // Removing waits for at most the world's own tick, whose error may still
+  // be reported after.
+  ASSERT_TRUE(runner.RemoveWorld(failing));
+  const auto failuresAtRemoval = failures.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  runner.Stop();
+
+  ASSERT_GT(failuresAtRemoval, 0);
+  ASSERT_LE(failures.load(), failuresAtRemoval + 1);
+  ASSERT_EQ(failing, failedWorld.load());
+  ASSERT_GT(runner.GetTickCount(healthy), 0u);
+}
+
+TEST(ChildContextInstances, InstancesOfOneTypeAreIndependent) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  const auto first = context->AddChildContextInstance<SessionContext>();
+  const auto second = context->AddChildContextInstance<SessionContext>();
+  ASSERT_NE(first, second);
+
+  auto firstSession = context->GetChildContext<SessionContext>(first);
+  auto secondSession = context->GetChildContext<SessionContext>(second);
+  ASSERT_NE(firstSession, secondSession);
+  ASSERT_NE(firstSession->Resolve<TimeModel>(),
+            secondSession->Resolve<TimeModel>());
+
+  // Each instance adds its own command to the parent's chain.
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice twice twice",
+            context->Resolve<SingletonTestModel>()->phrase);
+
+  ASSERT_TRUE(context->RemoveChildContext(first));
+  ASSERT_FALSE(context->RemoveChildContext(first));
+  ASSERT_THROW(context->GetChildContext<SessionContext>(first),
+               std::runtime_error);
+  ASSERT_THROW(context->GetChildContext<SessionContext>(),
+               std::runtime_error);
+
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice twice",
+            context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(ChildContextInstances, RemovedInstancesAreRecycled) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  const auto first = context->AddChildContextInstance<SessionContext>();
+  auto session = context->GetChildContext<SessionContext>(first);
+  session->Enter();
+  session->Resolve<TimeModel>()->totalTime = 10.0;
+  session->AddUpdatable<RateLimitedUpdatable>(
+      std::make_shared<RateLimitedUpdatable>());
+  session->Store<BaseTestModel>(std::make_shared<BaseTestModel>());
+
+  context->RemoveChildContext(first);
+  ASSERT_EQ(1u, context->GetPooledChildContextCount<SessionContext>());
+
+  const auto second = context->AddChildContextInstance<SessionContext>();
+  ASSERT_NE(first, second);
+  ASSERT_EQ(0u, context->GetPooledChildContextCount<SessionContext>());
+
+  auto recycled = context->GetChildContext<SessionContext>(second);
+  ASSERT_EQ(session, recycled);
+  ASSERT_EQ(1, recycled->recycleCount);
+  ASSERT_EQ(0.0, recycled->Resolve<TimeModel>()->totalTime);
+  ASSERT_FALSE(recycled->HasUpdatable<RateLimitedUpdatable>());
+  ASSERT_FALSE(recycled->HasStored<BaseTestModel>());
+
+  // Its command is attached to the parent's signal again.
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice twice",
+            context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(ChildContextInstances, ReservedInstancesComeFromThePool) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  context->ReserveChildContexts<SessionContext>(4);
+  ASSERT_EQ(4u, context->GetPooledChildContextCount<SessionContext>());
+
+  std::vector<ContextHandle> handles;
+  for (int i = 0; i < 4; ++i) {
+    handles.push_back(context->AddChildContextInstance<SessionContext>());
+  }
+  ASSERT_EQ(0u, context->GetPooledChildContextCount<SessionContext>());
+
+  auto updatable = std::make_shared<RateLimitedUpdatable>();
+  context->GetChildContext<SessionContext>(handles[2])
+      ->AddUpdatable<RateLimitedUpdatable>(updatable);
+  context->Tick(0.016);
+  ASSERT_EQ(1, updatable->updateCount);
+
+  const auto metrics = context->SnapshotMetrics();
+  ASSERT_EQ(4u, metrics.childContextsCreated);
+}
+
+TEST(BindingTemplates, LaterContextsReuseTheRecordedBindings) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto first = context->AddChildContext<TemplatedSessionContext>();
+  const auto calls = TemplatedSessionContext::setBindingsCalls;
+  auto firstTime = first->Resolve<TimeModel>();
+  context->RemoveChildContext<TemplatedSessionContext>();
+
+  auto second = context->AddChildContext<TemplatedSessionContext>();
+  second->Enter();
+  ASSERT_EQ(calls, TemplatedSessionContext::setBindingsCalls);
+
+  // Singletons are still made per context.
+  ASSERT_NE(firstTime, second->Resolve<TimeModel>());
+  ASSERT_EQ("child", second->Resolve<TestModelChild>()->phrase);
+
+  // Its own signal and the parent's both run its commands.
+  second->Resolve<TestSignal1>()->Dispatch();
+  ASSERT_EQ("changed", context->Resolve<SingletonTestModel>()->phrase);
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice twice",
+            context->Resolve<SingletonTestModel>()->phrase);
+
+  context->RemoveChildContext<TemplatedSessionContext>();
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice", context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(BindingTemplates, DifferentInheritedBindingsGetTheirOwnTemplate) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  context->AddChildContext<TemplatedSessionContext>();
+  const auto calls = TemplatedSessionContext::setBindingsCalls;
+  context->RemoveChildContext<TemplatedSessionContext>();
+  auto child = context->AddChildContext<TemplatedSessionContext>();
+  ASSERT_EQ(calls, TemplatedSessionContext::setBindingsCalls);
+
+  // Nothing to inherit here, so the child owns TestSignal2.
+  ASSERT_THROW(context->Resolve<TestSignal2>(), std::runtime_error);
+  child->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("default twice", context->Resolve<SingletonTestModel>()->phrase);
+}
+
+template <class T>
+bool PreUpdateUntilReady(const std::shared_ptr<ContextBase>& context,
+                         std::future<T>& future) {
+  for (int i = 0; i < 1000; ++i) {
+    context->PreUpdate();
+    if (future.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+TEST(AsyncChildContexts, AttachedAndEnteredAtPreUpdate) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+  context->SetWorkerPool(std::make_shared<WorkStealingPool>(1));
+
+  auto future = context->AddChildContextAsync<ChildContext>();
+  ASSERT_THROW(context->GetChildContext<ChildContext>(), std::runtime_error);
+  ASSERT_EQ("default parent_context_enter",
+            context->Resolve<SingletonTestModel>()->phrase);
+
+  ASSERT_TRUE(PreUpdateUntilReady<std::shared_ptr<ChildContext>>(context,
+                                                                  future));
+  ASSERT_EQ(context->GetChildContext<ChildContext>(), future.get());
+  ASSERT_EQ("default parent_context_enter child_context_enter",
+            context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(AsyncChildContexts, InheritedSignalsAreAttachedOnSwapIn) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+  context->SetWorkerPool(std::make_shared<WorkStealingPool>(1));
+
+  auto future = context->AddChildContextAsync<SessionContext>();
+  ASSERT_TRUE(PreUpdateUntilReady<std::shared_ptr<SessionContext>>(context,
+                                                                    future));
+
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice twice",
+            context->Resolve<SingletonTestModel>()->phrase);
+
+  context->RemoveChildContext<SessionContext>();
+  context->Resolve<TestSignal2>()->Dispatch();
+  ASSERT_EQ("changed twice", context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(AsyncChildContexts, BuildErrorsArriveThroughTheFuture) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  // No pool, so it builds inline but still waits for PreUpdate.
+  auto future = context->AddChildContextAsync<BrokenSingletonContext>();
+  ASSERT_NE(std::future_status::ready,
+            future.wait_for(std::chrono::seconds(0)));
+
+  context->PreUpdate();
+  ASSERT_THROW(future.get(), std::runtime_error);
+  ASSERT_THROW(context->GetChildContext<BrokenSingletonContext>(),
+               std::runtime_error);
+}
+
+TEST(Reclamation, RemovedChildContextIsReleasedInPostUpdate) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  std::weak_ptr<ChildContext> child =
+      context->AddChildContext<ChildContext>();
+  context->RemoveChildContext<ChildContext>();
+  ASSERT_FALSE(child.expired());
+  ASSERT_EQ(1u, context->GetReclaimer()->GetPendingCount());
+
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+  ASSERT_TRUE(child.expired());
+  ASSERT_EQ(0u, context->GetReclaimer()->GetPendingCount());
+}
+
+TEST(Reclamation, RemovedStoredObjectsAndUpdatablesAreRetired) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto stored = std::make_shared<BaseTestModel>();
+  std::weak_ptr<BaseTestModel> weakStored = stored;
+  context->Store<BaseTestModel>(std::move(stored));
+  context->DeleteFromStore<BaseTestModel>();
+
+  auto updatable = std::make_shared<RateLimitedUpdatable>();
+  std::weak_ptr<RateLimitedUpdatable> weakUpdatable = updatable;
+  context->AddUpdatable<RateLimitedUpdatable>(std::move(updatable));
+  context->RemoveUpdatable<RateLimitedUpdatable>();
+
+  context->PreUpdate();
+  ASSERT_FALSE(context->HasStored<BaseTestModel>());
+  ASSERT_FALSE(context->HasUpdatable<RateLimitedUpdatable>());
+  ASSERT_FALSE(weakStored.expired());
+  ASSERT_FALSE(weakUpdatable.expired());
+
+  // Anything still holding a reference keeps the object alive.
+  auto stillHeld = weakStored.lock();
+
+  context->Update(0.016);
+  context->PostUpdate();
+  ASSERT_TRUE(weakUpdatable.expired());
+  ASSERT_FALSE(weakStored.expired());
+  ASSERT_EQ(2u, context->GetReclaimer()->GetReleasedCount());
+
+  stillHeld.reset();
+  ASSERT_TRUE(weakStored.expired());
+}
+
+TEST(Reclamation, BackgroundModeReleasesOffTheUpdateThread) {
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  auto context = std::make_shared<BackgroundReclaimContext>();
+  context->Initialise();
+  context->Enter();
+  ASSERT_EQ(Reclaimer::Mode::Background,
+            context->GetReclaimer()->GetMode());
+
+  std::weak_ptr<ChildContext> child =
+      context->AddChildContext<ChildContext>();
+  context->RemoveChildContext<ChildContext>();
+
+  for (int i = 0; i < 1000 && !child.expired(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(child.expired());
+}
+
+TEST(Reclamation, DestroyingTheRootReleasesPendingRetirements) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  std::weak_ptr<ChildContext> child =
+      context->AddChildContext<ChildContext>();
+  context->RemoveChildContext<ChildContext>();
+  ASSERT_EQ(1u, context->GetReclaimer()->GetPendingCount());
+
+  context.reset();
+  ASSERT_TRUE(child.expired());
+}
+
+TEST(Reclamation, DestroyingABackgroundRootWhileItReleasesIsSafe) {
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  auto context = std::make_shared<BackgroundReclaimContext>();
+  context->Initialise();
+  context->Enter();
+
+  std::vector<std::weak_ptr<SlowTeardownContext>> children;
+  for (int i = 0; i < 20; ++i) {
+    children.push_back(context->AddChildContext<SlowTeardownContext>());
+    context->RemoveChildContext<SlowTeardownContext>();
+  }
+
+  // Destroyed here with the reclaimer thread still releasing.
+  context.reset();
+  for (const auto& child : children) {
+    ASSERT_TRUE(child.expired());
+  }
+}
+
+TEST(ThreadingPolicies, PolicyMatchesTheBuild) {
+#if defined(CULPRIT_SINGLE_THREADED)
+  ASSERT_TRUE(ThreadingPolicy::IsSingleThreaded);
+#else
+  ASSERT_FALSE(ThreadingPolicy::IsSingleThreaded);
+#endif
+
+  ThreadingPolicy::Counter<std::size_t> counter{1};
+  ASSERT_EQ(1u, counter.fetch_add(2));
+  ASSERT_EQ(3u, counter.load());
+
+  ThreadingPolicy::Mutex mutex;
+  {
+    std::lock_guard<ThreadingPolicy::Mutex> lock(mutex);
+    counter.store(0);
+  }
+  ASSERT_EQ(0u, counter.load());
+}
+
+TEST(ThreadingPolicies, MetricsCountWithEitherPolicy) {
+  auto context = std::make_shared<MetricsContext>();
+  context->Initialise();
+  context->Enter();
+
+  const auto before = context->SnapshotMetrics();
+  context->Resolve<TestSignal2>()->Dispatch();
+  context->Resolve<TestSignal2>()->Dispatch();
+  const auto after = context->SnapshotMetrics();
+
+  ASSERT_EQ(before.commandChainsStarted + 2, after.commandChainsStarted);
+}
+
+TEST(ConcurrentResolving, WorkersResolveWhileTheTreeChanges) {
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  auto context = std::make_shared<ConcurrentResolveContext>();
+  context->Initialise();
+  context->Enter();
+  const auto singleton = context->Resolve<SingletonTestModel>();
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> workers;
+  for (int i = 0; i < 4; ++i) {
+    workers.emplace_back([&]() {
+      while (!stop.load()) {
+        if (context->Resolve<SingletonTestModel>() != singleton ||
+            context->ResolveRef<SingletonTestModel>().get() !=
+                singleton.get() ||
+            context->Resolve<TestModelWith1Dependency>()->phrase !=
+                "the answer to life, ") {
+          ++mismatches;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    context->AddChildContext<ChildContext>();
+    context->Store<TestModelChild>(std::make_shared<TestModelChild>());
+    context->Tick(0.016);
+    context->RemoveChildContext<ChildContext>();
+    context->DeleteFromStore<TestModelChild>();
+    context->Tick(0.016);
+  }
+
+  stop = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  ASSERT_EQ(0, mismatches.load());
+}
+
+TEST(ConcurrentResolving, RecycledContextsPublishTheirNewSingletons) {
+  auto context = std::make_shared<SignalForAttachDetachContext>();
+  context->Initialise();
+
+  auto handle = context->AddChildContextInstance<ConcurrentResolveContext>();
+  const auto first = context->GetChildContext<ConcurrentResolveContext>(handle)
+                         ->Resolve<BoundDependency1>();
+  context->RemoveChildContext(handle);
+
+  handle = context->AddChildContextInstance<ConcurrentResolveContext>();
+  const auto second = context->GetChildContext<ConcurrentResolveContext>(handle)
+                          ->Resolve<BoundDependency1>();
+  ASSERT_NE(first, second);
+  ASSERT_EQ(second, context->GetChildContext<ConcurrentResolveContext>(handle)
+                        ->Resolve<BoundDependency1>());
+}
+
+TEST(NonThrowingLookups, MissesReturnEmptyWithoutAllocating) {
+  auto context = std::make_shared<BasicUpdatableContext>();
+  context->Initialise();
+
+  EXPECT_NO_ALLOCATIONS({
+    ASSERT_EQ(nullptr, context->TryResolve<SingletonTestModel>());
+    ASSERT_EQ(nullptr, context->TryGetFromStore<BaseTestModel>());
+    ASSERT_EQ(nullptr, context->TryGetFromSharedStore<BaseTestModel>());
+    ASSERT_EQ(nullptr, context->TryGetUpdatable<TestUpdatable>());
+    ASSERT_EQ(nullptr, context->TryGetChildContext<ChildContext>());
+    ASSERT_EQ(nullptr, context->TryGetChildContext<ChildContext>(42));
+  });
+}
+
+TEST(NonThrowingLookups, HitsMatchTheThrowingLookups) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+
+  ASSERT_EQ(context->Resolve<SingletonTestModel>(),
+            context->TryResolve<SingletonTestModel>());
+  ASSERT_EQ(context, context->TryResolve<ContextBase>());
+
+  const auto stored = std::make_shared<BaseTestModel>();
+  context->Store<BaseTestModel>(stored);
+  ASSERT_EQ(stored, context->TryGetFromStore<BaseTestModel>());
+  ASSERT_EQ(nullptr, (context->TryGetFromStore<BaseTestModel, 1>()));
+
+  const auto child = context->AddChildContext<ChildContext>();
+  ASSERT_EQ(child, context->TryGetChildContext<ChildContext>());
+
+  const auto handle = context->AddChildContextInstance<ChildContext>();
+  const auto instance = context->TryGetChildContext<ChildContext>(handle);
+  ASSERT_NE(nullptr, instance);
+  ASSERT_EQ(instance, context->GetChildContext<ChildContext>(handle));
+  context->RemoveChildContext(handle);
+  ASSERT_EQ(nullptr, context->TryGetChildContext<ChildContext>(handle));
+}
+
+TEST(SharedStore, OneStoreIsSharedByTheWholeTree) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  auto child = context->AddChildContext<ChildContext>();
+
+  // Stored after the child was added, and seen from both directions.
+  const auto fromParent = std::make_shared<BaseTestModel>();
+  context->StoreShared<BaseTestModel>(fromParent);
+  ASSERT_EQ(fromParent, child->GetFromSharedStore<BaseTestModel>());
+
+  const auto fromChild = std::make_shared<TestModelChild>();
+  child->StoreShared<TestModelChild>(fromChild);
+  ASSERT_EQ(fromChild, context->GetFromSharedStore<TestModelChild>());
+
+  // The writer sees the removal straight away, readers at the commit.
+  const auto store = context->GetSharedStore();
+  context->Tick(0.016);
+  child->DeleteFromSharedStore<BaseTestModel>();
+  ASSERT_FALSE(context->HasSharedStored<BaseTestModel>());
+  ASSERT_EQ(nullptr, context->TryGetFromSharedStore<BaseTestModel>());
+  ASSERT_EQ(fromParent, store->Get<BaseTestModel>());
+  context->Tick(0.016);
+  ASSERT_FALSE(context->HasSharedStored<BaseTestModel>());
+  ASSERT_EQ(nullptr, store->Get<BaseTestModel>());
+  ASSERT_THROW(child->GetFromSharedStore<BaseTestModel>(), std::runtime_error);
+}
+
+TEST(SharedStore, OtherThreadsReadTheCommittedSnapshot) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  const auto store = context->GetSharedStore();
+
+  auto model = std::make_shared<BaseTestModel>();
+  model->phrase = "shared";
+  context->StoreShared<BaseTestModel>(model);
+  ASSERT_EQ(nullptr, store->Get<BaseTestModel>());
+  context->Tick(0.016);
+  ASSERT_EQ(model, store->Get<BaseTestModel>());
+  ASSERT_EQ(1u, store->GetVersion());
+
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> misses{0};
+  std::thread reader([&]() {
+    while (!stop.load()) {
+      const auto seen = store->Get<BaseTestModel>();
+      if (!seen || seen->phrase != "shared") {
+        ++misses;
+      }
+    }
+  });
+
+  for (int i = 0; i < 500; ++i) {
+    auto next = std::make_shared<BaseTestModel>();
+    next->phrase = "shared";
+    context->StoreShared<BaseTestModel>(next);
+    context->Tick(0.016);
+  }
+
+  stop = true;
+  reader.join();
+  ASSERT_EQ(0, misses.load());
+  ASSERT_EQ(501u, store->GetVersion());
+}
+
+TEST(KeyedStore, StoresLooksUpAndIteratesById) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+
+  for (KeyedId id = 0; id < 100; ++id) {
+    context->StoreKeyed(id * 7, KeyedTestComponent{static_cast<int>(id)});
+  }
+  ASSERT_EQ(42, context->GetKeyed<KeyedTestComponent>(42 * 7).value);
+  ASSERT_EQ(nullptr, context->TryGetKeyed<KeyedTestComponent>(1));
+  ASSERT_THROW(context->GetKeyed<KeyedTestComponent>(1), std::runtime_error);
+
+  // Storing under an id again replaces the value.
+  context->StoreKeyed(42 * 7, KeyedTestComponent{-1});
+  ASSERT_EQ(-1, context->GetKeyed<KeyedTestComponent>(42 * 7).value);
+
+  auto& store = context->GetKeyedStore<KeyedTestComponent>();
+  ASSERT_EQ(100u, store.size());
+  int sum = 0;
+  for (auto& component : store) {
+    sum += component.value;
+  }
+  ASSERT_EQ(99 * 100 / 2 - 43, sum);
+  ASSERT_EQ(static_cast<std::int64_t>(100 * sizeof(KeyedTestComponent)),
+            context->SnapshotMetrics().storedBytes);
+}
+
+TEST(KeyedStore, DeletionsWaitForPreUpdate) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->StoreKeyed(1, KeyedTestComponent{1});
+  context->StoreKeyed(2, KeyedTestComponent{2});
+
+  context->DeleteKeyed<KeyedTestComponent>(1);
+  ASSERT_TRUE(context->HasKeyed<KeyedTestComponent>(1));
+  context->PreUpdate();
+  ASSERT_FALSE(context->HasKeyed<KeyedTestComponent>(1));
+  ASSERT_EQ(2, context->GetKeyed<KeyedTestComponent>(2).value);
+  ASSERT_THROW(context->DeleteKeyed<KeyedTestComponent>(1),
+               std::runtime_error);
+
+  // Storing again before the PreUpdate keeps the object.
+  context->DeleteKeyed<KeyedTestComponent>(2);
+  context->StoreKeyed(2, KeyedTestComponent{3});
+  context->PreUpdate();
+  ASSERT_EQ(3, context->GetKeyed<KeyedTestComponent>(2).value);
+  ASSERT_EQ(static_cast<std::int64_t>(sizeof(KeyedTestComponent)),
+            context->SnapshotMetrics().storedBytes);
+}
+
+TEST(KeyedStore, MatchesAMapThroughChurn) {
+  KeyedStore<int> store;
+  std::unordered_map<KeyedId, int> expected;
+
+  std::uint64_t seed = 12345;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    const KeyedId id = (seed >> 33) % 2000;
+    if ((seed >> 20) % 3 == 0) {
+      store.Remove(id);
+      store.ApplyRemovals();
+      expected.erase(id);
+    } else {
+      store.Put(id, i);
+      expected[id] = i;
+    }
+  }
+
+  ASSERT_EQ(expected.size(), store.size());
+  for (const auto& entry : expected) {
+    ASSERT_NE(nullptr, store.Find(entry.first));
+    ASSERT_EQ(entry.second, *store.Find(entry.first));
+  }
+  for (std::size_t i = 0; i < store.size(); ++i) {
+    ASSERT_EQ(expected.at(store.ids()[i]), store.values()[i]);
+  }
+}
+
+TEST(Snapshots, ReadersSeeTheLastPostUpdate) {
+  auto context = std::make_shared<SnapshotContext>();
+  context->Initialise();
+  context->Enter();
+  const auto snapshot = context->Resolve<Snapshotted<TimeModel>>();
+
+  auto built = snapshot->Read();
+  ASSERT_TRUE(built);
+  ASSERT_EQ(0.0, built->totalTime);
+
+  context->PreUpdate();
+  context->Update(0.5);
+  ASSERT_EQ(0.5, context->Resolve<TimeModel>()->totalTime);
+  ASSERT_EQ(0.0, snapshot->Read()->totalTime);
+  context->PostUpdate();
+  ASSERT_EQ(0.5, snapshot->Read()->totalTime);
+
+  // A held view isn't overwritten by later frames.
+  for (int i = 0; i < 4; ++i) {
+    context->Tick(0.5);
+  }
+  ASSERT_EQ(0.0, built->totalTime);
+  const auto latest = snapshot->Read();
+  ASSERT_EQ(2.5, latest->totalTime);
+  ASSERT_LT(built.GetVersion(), latest.GetVersion());
+}
+
+TEST(Snapshots, OtherThreadsReadConsistentFrames) {
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  auto context = std::make_shared<SnapshotContext>();
+  context->Initialise();
+  const auto model = context->Resolve<FrameModel>();
+  const auto snapshot = context->Resolve<Snapshotted<FrameModel>>();
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> torn{0};
+  auto read = [&]() {
+    int lastFrame = 0;
+    while (!stop.load()) {
+      const auto view = snapshot->Read();
+      if (view->doubled != view->frame * 2 || view->frame < lastFrame) {
+        ++torn;
+      }
+      lastFrame = view->frame;
+    }
+  };
+  std::thread renderer(read);
+  std::thread telemetry(read);
+
+  for (int frame = 1; frame <= 2000; ++frame) {
+    model->frame = frame;
+    model->doubled = frame * 2;
+    context->PostUpdate();
+  }
+
+  stop = true;
+  renderer.join();
+  telemetry.join();
+  ASSERT_EQ(0, torn.load());
+  ASSERT_EQ(2000, snapshot->Read()->frame);
+}
+
+TEST(StaticContexts, ResolvesStaticBindingsAndFallsBackToParent) {
+  static_assert(StaticHotContext::IsStaticallyBound<BoundDependency1>(), "");
+  static_assert(!StaticHotContext::IsStaticallyBound<BoundDependency2>(), "");
+
+  auto context = std::make_shared<StaticParentContext>();
+  context->Initialise();
+  auto hot = context->AddChildContext<StaticHotContext>();
+
+  auto singleton = hot->Get<BoundDependency1>();
+  ASSERT_EQ(singleton, hot->Get<BoundDependency1>());
+  ASSERT_EQ(singleton, hot->Resolve<BoundDependency1>());
+
+  auto model = hot->Get<BaseTestModel>();
+  ASSERT_NE(model, hot->Get<BaseTestModel>());
+  ASSERT_EQ("the answer to life, the universe, ", model->phrase);
+
+  // Keys outside the static list come from the runtime bindings.
+  ASSERT_EQ(context->Resolve<BoundDependency2>(),
+            hot->Get<BoundDependency2>());
+  ASSERT_EQ(hot->Resolve<SingletonTestModel>(),
+            hot->Get<SingletonTestModel>());
+}
+
+TEST(StaticContexts, RuntimeChildrenResolveStaticBindings) {
+  auto context = std::make_shared<StaticParentContext>();
+  context->Initialise();
+  auto hot = context->AddChildContext<StaticHotContext>();
+  auto child = hot->AddChildContext<RuntimeChildContext>();
+
+  ASSERT_EQ(hot->Get<BoundDependency1>(), child->Resolve<BoundDependency1>());
+  ASSERT_EQ("the answer to life, the universe, ",
+            child->Resolve<BaseTestModel>()->phrase);
+  ASSERT_THROW(context->Resolve<BoundDependency1>(), std::runtime_error);
+}
+
+TEST(StaticContexts, StaticBindingsShadowTheParents) {
+  auto context = std::make_shared<ShadowedParentContext>();
+  context->Initialise();
+
+  const auto handle = context->AddChildContextInstance<StaticHotContext>();
+  auto hot = context->GetChildContext<StaticHotContext>(handle);
+  auto child = hot->AddChildContext<RuntimeChildContext>();
+  ASSERT_NE(context->Resolve<BoundDependency1>(), hot->Get<BoundDependency1>());
+  ASSERT_EQ(hot->Get<BoundDependency1>(), hot->Resolve<BoundDependency1>());
+  ASSERT_EQ(hot->Get<BoundDependency1>(), child->Resolve<BoundDependency1>());
+
+  // Still shadowed once recycled.
+  context->RemoveChildContext(handle);
+  auto recycled = context->GetChildContext<StaticHotContext>(
+      context->AddChildContextInstance<StaticHotContext>());
+  ASSERT_EQ(hot, recycled);
+  ASSERT_NE(context->Resolve<BoundDependency1>(),
+            recycled->Resolve<BoundDependency1>());
+  ASSERT_EQ(recycled->Get<BoundDependency1>(),
+            recycled->Resolve<BoundDependency1>());
+}
+
+TEST(StaticContexts, RecycledRuntimeSingletonsUseTheNewStaticOnes) {
+  auto context = std::make_shared<StaticParentContext>();
+  context->Initialise();
+
+  const auto first = context->AddChildContextInstance<RecyclingStaticContext>();
+  auto hot = context->GetChildContext<RecyclingStaticContext>(first);
+  const auto firstSingleton = hot->Get<BoundDependency1>();
+  ASSERT_EQ(firstSingleton, hot->Resolve<BoundDependencyHolder>()->dependency);
+
+  context->RemoveChildContext(first);
+  const auto second =
+      context->AddChildContextInstance<RecyclingStaticContext>();
+  auto recycled = context->GetChildContext<RecyclingStaticContext>(second);
+  ASSERT_EQ(hot, recycled);
+
+  ASSERT_NE(firstSingleton, recycled->Get<BoundDependency1>());
+  ASSERT_EQ(recycled->Get<BoundDependency1>(),
+            recycled->Resolve<BoundDependencyHolder>()->dependency);
+}
+
+TEST(StaticContexts, WorkersResolveOneSingletonInstance) {
+  if (ThreadingPolicy::IsSingleThreaded) {
+    GTEST_SKIP() << "Built with CULPRIT_SINGLE_THREADED";
+  }
+
+  auto context = std::make_shared<StaticParentContext>();
+  context->Initialise();
+  auto hot = context->AddChildContext<StaticHotContext>();
+  auto child = hot->AddChildContext<RuntimeChildContext>();
+
+  std::atomic<bool> start{false};
+  std::vector<std::shared_ptr<BoundDependency1>> resolved(8);
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < resolved.size(); ++i) {
+    workers.emplace_back([&, i] {
+      while (!start) {
+      }
+      resolved[i] = i % 2 == 0 ? hot->Get<BoundDependency1>()
+                               : child->Resolve<BoundDependency1>();
+    });
+  }
+  start = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (const auto& instance : resolved) {
+    ASSERT_EQ(hot->Get<BoundDependency1>(), instance);
+  }
+}
+
+TEST(StaticSignals, DispatchRunsTheChainInOrderWithTypedArguments) {
+  auto context = std::make_shared<StaticSignalContext>();
+  context->Initialise();
+
+  auto signal = context->Resolve<StaticPhraseSignal>();
+  signal->Dispatch("the answer ", "is 42");
+  signal->Dispatch("so ", "long");
+
+  ASSERT_EQ("so long", context->Resolve<SingletonTestModel>()->phrase);
+  const auto& seen = signal->GetCommand<StaticRecordingCommand>().seenPhrases;
+  ASSERT_EQ(2u, seen.size());
+  ASSERT_EQ("the answer is 42", seen[0]);
+  ASSERT_EQ("so long", seen[1]);
+  ASSERT_EQ(2u, signal->GetDispatchCount());
+}
+
+TEST(StaticSignals, AttachedObserversAreNotifiedAfterTheChain) {
+  auto context = std::make_shared<StaticSignalContext>();
+  context->Initialise();
+  auto child = context->AddChildContext<RuntimeChildContext>();
+
+  // The child inherits the same signal and its commands.
+  auto signal = child->Resolve<StaticPhraseSignal>();
+  ASSERT_EQ(context->Resolve<StaticPhraseSignal>(), signal);
+
+  AttachToSignalClass observer;
+  signal->Attach(&observer, &AttachToSignalClass::function1);
+  signal->Dispatch("a", "b");
+
+  ASSERT_EQ("01", observer.functionHistory);
+  ASSERT_EQ("ab", context->Resolve<SingletonTestModel>()->phrase);
+}
+
+TEST(AllocationTracking, DispatchToObserversDoesNotAllocate) {
+  if (!AllocationTracker::IsEnabled()) {
+    GTEST_SKIP() << "Built without CULPRIT_TRACK_ALLOCATIONS";
+  }
+
+  auto signal = std::make_shared<SignalForAttach>();
+  signal->Attach(&CanAttachFreeFunctions_Func1);
+  signal->Attach(&CanAttachFreeFunctions_Func2);
+  auto withArgs = std::make_shared<SignalWith2Args>();
+  const std::string first = "a";
+  const std::string second = "b";
+
+  EXPECT_NO_ALLOCATIONS({ signal->Dispatch(); });
+  EXPECT_NO_ALLOCATIONS({
+    withArgs->Dispatch(std::string(first), std::string(second));
+  });
+
+  auto context = std::make_shared<StaticSignalContext>();
+  context->Initialise();
+  auto staticSignal = context->Resolve<StaticPhraseSignal>();
+  // Room for what the recording command keeps.
+  staticSignal->GetCommand<StaticRecordingCommand>().seenPhrases.reserve(2);
+  staticSignal->Dispatch(first, second);
+  EXPECT_NO_ALLOCATIONS({ staticSignal->Dispatch(first, second); });
+}
+
+TEST(AllocationTracking, SteadyStateUpdateDoesNotAllocate) {
+  if (!AllocationTracker::IsEnabled()) {
+    GTEST_SKIP() << "Built without CULPRIT_TRACK_ALLOCATIONS";
+  }
+
+  auto context = std::make_shared<BasicUpdatableContext>();
+  context->Initialise();
+  context->Enter();
+  context->AddUpdatable<RateLimitedUpdatable>(
+      std::make_shared<RateLimitedUpdatable>(), UpdateRate::EveryNthFrame(2));
+  auto child = context->AddChildContext<ParentContext>();
+  child->Enter();
+
+  // The first frames build the traversal caches.
+  context->Tick(0.016);
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+
+  EXPECT_NO_ALLOCATIONS({
+    context->PreUpdate();
+    context->Update(0.016);
+    context->PostUpdate();
+  });
+  EXPECT_NO_ALLOCATIONS({ context->Tick(0.016); });
+}
+
+TEST(AllocationTracking, AttributesAllocationsToOperations) {
+  if (!AllocationTracker::IsEnabled()) {
+    GTEST_SKIP() << "Built without CULPRIT_TRACK_ALLOCATIONS";
+  }
+
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  auto commandContext = std::make_shared<SignalsWithCommandsContext>();
+  commandContext->Initialise();
+  commandContext->Enter();
+  AllocationTracker::Reset();
+
+  context->Resolve<BaseTestModel>();
+  EXPECT_GT(AllocationTracker::GetCount(AllocationSite::Resolve), 0u);
+
+  context->Store<BaseTestModel>(std::make_shared<BaseTestModel>());
+  EXPECT_GT(AllocationTracker::GetCount(AllocationSite::Store), 0u);
+
+  EXPECT_EQ(0u, AllocationTracker::GetCount(AllocationSite::Command));
+  commandContext->Resolve<TestSignal1>()->Dispatch();
+  EXPECT_GT(AllocationTracker::GetCount(AllocationSite::Command), 0u);
+}
+
+TEST(AllocationTracking, CountsOverAlignedAllocations) {
+  if (!AllocationTracker::IsEnabled()) {
+    GTEST_SKIP() << "Built without CULPRIT_TRACK_ALLOCATIONS";
+  }
+
+  const auto before = AllocationTracker::GetThreadCount();
+  auto model = std::make_unique<OverAlignedTestModel>();
+  auto models = std::make_unique<OverAlignedTestModel[]>(4);
+  EXPECT_EQ(before + 2, AllocationTracker::GetThreadCount());
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(model.get()) % 64);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(models.get()) % 64);
+
+  const auto beforeSignal = AllocationTracker::GetThreadCount();
+  auto signal = std::make_shared<Signal<>>();
+  EXPECT_EQ(beforeSignal + 1, AllocationTracker::GetThreadCount());
+}
+
+int g_newHandlerCalls = 0;
+
+TEST(AllocationTracking, FailedAllocationsCallTheNewHandler) {
+  if (!AllocationTracker::IsEnabled()) {
+    GTEST_SKIP() << "Built without CULPRIT_TRACK_ALLOCATIONS";
+  }
+
+  // Too large for any allocator, and volatile so it isn't folded away.
+  volatile std::size_t size = std::numeric_limits<std::size_t>::max() / 2;
+  const auto giveUp = []() {
+    ++g_newHandlerCalls;
+    std::set_new_handler(nullptr);
+  };
+
+  g_newHandlerCalls = 0;
+  std::set_new_handler(giveUp);
+  EXPECT_THROW(::operator delete(::operator new(size)), std::bad_alloc);
+  EXPECT_EQ(1, g_newHandlerCalls);
+
+  std::set_new_handler(giveUp);
+  EXPECT_EQ(nullptr, ::operator new(size, std::nothrow));
+  EXPECT_EQ(2, g_newHandlerCalls);
+}
+
+TEST(BorrowedResolution, BorrowsSingletonsWithoutSharingOwnership) {
+  auto context = std::make_shared<BorrowingContext>();
+  context->Initialise();
+
+  auto shared = context->Resolve<SingletonTestModel>();
+  const auto useCount = shared.use_count();
+
+  auto borrowed = context->ResolveRef<SingletonTestModel>();
+  Borrowed<BaseTestModel> asBase = borrowed;
+  ASSERT_EQ(shared.get(), borrowed.get());
+  ASSERT_EQ(shared.get(), asBase.get());
+  ASSERT_EQ(useCount, shared.use_count());
+
+  ASSERT_THROW(context->ResolveRef<BaseTestModel>(), std::runtime_error);
+  ASSERT_THROW(context->ResolveRef<UnboundModel1>(), std::runtime_error);
+
+  context->Resolve<TestSignal1>()->Dispatch();
+  ASSERT_EQ("borrowed", shared->phrase);
+}
+
+TEST(BorrowedResolution, BorrowsStoredObjectsUpdatablesAndChildren) {
+  auto context = std::make_shared<ParentContext>();
+  context->Initialise();
+  context->Enter();
+
+  auto stored = std::make_shared<BaseTestModel>();
+  context->Store<BaseTestModel>(stored);
+  ASSERT_EQ(stored.get(), context->GetFromStoreRef<BaseTestModel>().get());
+
+  context->AddUpdatable<RateLimitedUpdatable>(
+      std::make_shared<RateLimitedUpdatable>());
+  ASSERT_EQ(context->GetUpdatable<RateLimitedUpdatable>().get(),
+            context->GetUpdatableRef<RateLimitedUpdatable>().get());
+
+  auto child = context->AddChildContext<ChildContext>();
+  ASSERT_EQ(child.get(), context->GetChildContextRef<ChildContext>().get());
+}
+
+TEST(BorrowedResolution, UsingABorrowAfterItsOwnerIsReleasedAsserts) {
+  auto context = std::make_shared<BasicContext>();
+  context->Initialise();
+  context->Enter();
+
+  context->Store<BaseTestModel>(std::make_shared<BaseTestModel>());
+  auto borrowed = context->GetFromStoreRef<BaseTestModel>();
+  context->DeleteFromStore<BaseTestModel>();
+  context->PreUpdate();
+  context->Update(0.016);
+  context->PostUpdate();
+
+  ASSERT_DEATH(borrowed->phrase = "dangling",
+               "Borrowed object was released while still in use.");
+}
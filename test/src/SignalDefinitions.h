@@ -1,6 +1,8 @@
 #pragma once
 #include <culprit-framework/CulpritFramework.h>
 
+#include <stdexcept>
+
 using namespace culprit::framework;
 
 ///
@@ -34,6 +36,23 @@ class AttachToSignalClass {
   std::string functionHistory = "0";
 };
 
+// Attaches the observer it was given, then throws out of the dispatch.
+class ThrowingObserver {
+ public:
+  ThrowingObserver(Signal<>& signal, AttachToSignalClass& observer)
+      : m_signal{signal}, m_observer{observer} {}
+
+  void function() {
+    m_signal.Attach<AttachToSignalClass>(&m_observer,
+                                         &AttachToSignalClass::function1);
+    throw std::runtime_error("observer failed");
+  }
+
+ private:
+  Signal<>& m_signal;
+  AttachToSignalClass& m_observer;
+};
+
 class TestSignal1 : public Signal<> {};
 class TestSignal2 : public Signal<> {};
 class TestSignal3 : public Signal<> {};